@@ -0,0 +1,206 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+// C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*##############################################################################
+ * Global macro
+ *############################################################################*/
+
+#define DBGROUP_ADD_QUOTES_INNER(x) #x                     // NOLINT
+#define DBGROUP_ADD_QUOTES(x) DBGROUP_ADD_QUOTES_INNER(x)  // NOLINT
+
+namespace dbgroup::pmem::atomic::bench
+{
+/*##############################################################################
+ * Global utility classes
+ *############################################################################*/
+
+/**
+ * @brief A generator of Zipf-distributed indices in [0, n).
+ *
+ * This class precomputes the cumulative distribution, so it should be shared
+ * by threads and each thread should own a random engine.
+ */
+class ZipfDistribution
+{
+ public:
+  /*############################################################################
+   * Public constructors and assignment operators
+   *##########################################################################*/
+
+  /**
+   * @param n The number of items.
+   * @param skew A skew parameter (zero gives a uniform distribution).
+   */
+  ZipfDistribution(  //
+      const size_t n,
+      const double skew)
+      : cdf_(n)
+  {
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+      cdf_[i] = sum;
+    }
+    for (auto &&prob : cdf_) {
+      prob /= sum;
+    }
+  }
+
+  /*############################################################################
+   * Public utility functions
+   *##########################################################################*/
+
+  /**
+   * @param rand_engine A random engine of the current thread.
+   * @return A Zipf-distributed index.
+   */
+  template <class RandEngine>
+  auto
+  operator()(  //
+      RandEngine &rand_engine) const  //
+      -> size_t
+  {
+    const auto prob = std::uniform_real_distribution<double>{0, 1}(rand_engine);
+    const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), prob);
+    return std::min(static_cast<size_t>(it - cdf_.begin()), cdf_.size() - 1);
+  }
+
+ private:
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief The cumulative distribution of items.
+  std::vector<double> cdf_{};
+};
+
+/**
+ * @brief A log-linear histogram of latency in nanoseconds.
+ *
+ * Each power of two is divided into 2^kSubBits buckets, so quantiles have a
+ * relative error of at most 1/2^kSubBits.
+ */
+class LatencyHistogram
+{
+ public:
+  /*############################################################################
+   * Public utility functions
+   *##########################################################################*/
+
+  /**
+   * @param nanos A measured latency in nanoseconds.
+   */
+  void
+  Record(  //
+      const uint64_t nanos)
+  {
+    ++buckets_[ToBucket(nanos)];
+    ++count_;
+  }
+
+  /**
+   * @param q A quantile in [0, 1].
+   * @return The representative latency of the quantile in nanoseconds.
+   */
+  [[nodiscard]] auto
+  Quantile(  //
+      const double q) const  //
+      -> double
+  {
+    if (count_ == 0) return 0;
+
+    const auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_)));
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kBucketNum; ++i) {
+      sum += buckets_[i];
+      if (sum >= std::max<uint64_t>(rank, 1)) return FromBucket(i);
+    }
+    return FromBucket(kBucketNum - 1);
+  }
+
+ private:
+  /*############################################################################
+   * Internal constants
+   *##########################################################################*/
+
+  /// @brief The number of bits for dividing each power of two.
+  static constexpr size_t kSubBits = 4;
+
+  /// @brief The number of buckets per power of two.
+  static constexpr size_t kSubNum = 1UL << kSubBits;
+
+  /// @brief The number of buckets for 64-bit values.
+  static constexpr size_t kBucketNum = (64 - kSubBits + 1) * kSubNum;
+
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  /**
+   * @param nanos A latency in nanoseconds.
+   * @return The index of the corresponding bucket.
+   */
+  static constexpr auto
+  ToBucket(  //
+      const uint64_t nanos)  //
+      -> size_t
+  {
+    if (nanos < kSubNum) return nanos;
+    const auto shift = static_cast<size_t>(63 - __builtin_clzl(nanos)) - kSubBits;
+    return (shift + 1) * kSubNum + ((nanos >> shift) & (kSubNum - 1));
+  }
+
+  /**
+   * @param i The index of a bucket.
+   * @return The middle latency of the bucket.
+   */
+  static auto
+  FromBucket(  //
+      const size_t i)  //
+      -> double
+  {
+    if (i < kSubNum) return static_cast<double>(i);
+    const auto shift = i / kSubNum - 1;
+    const auto low = static_cast<double>((kSubNum + i % kSubNum) << shift);
+    return low + static_cast<double>(1UL << shift) / 2;
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief The number of samples in each bucket.
+  std::array<uint64_t, kBucketNum> buckets_{};
+
+  /// @brief The total number of samples.
+  uint64_t count_{0};
+};
+
+}  // namespace dbgroup::pmem::atomic::bench
+
+#endif  // BENCH_COMMON_HPP
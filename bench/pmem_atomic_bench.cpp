@@ -0,0 +1,637 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// system libraries
+#include <sys/stat.h>
+
+// external system libraries
+#include <libpmemobj.h>
+
+// external libraries
+#include "benchmark/benchmark.h"
+#include "thread/common.hpp"
+
+// local sources
+#include "common.hpp"
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/persistent_list.hpp"
+#include "pmem/atomic/persistent_ring_buffer.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::bench
+{
+namespace
+{
+/*##############################################################################
+ * Local constants
+ *############################################################################*/
+
+/// @brief The number of target words shared by benchmark threads.
+constexpr size_t kWordNum = DBGROUP_BENCH_WORD_NUM;
+
+/// @brief The number of indices generated by each thread in advance.
+constexpr size_t kIndexNum = 1UL << 16UL;
+
+/// @brief An interval of operations for measuring latency.
+constexpr size_t kSampleInterval = 16;
+
+/// @brief The path to a persistent storage for benchmarks on PMEM.
+constexpr std::string_view kTmpPMEMPath = DBGROUP_ADD_QUOTES(DBGROUP_TEST_TMP_PMEM_PATH);
+
+/// @brief The layout name of a pool for target words.
+constexpr char kWordLayout[] = "pmem_atomic_bench_words";
+
+/// @brief The layout name of a pool for PMwCAS descriptors.
+constexpr char kDescLayout[] = "pmem_atomic_bench_desc";
+
+/// @brief The alignment of target words on DRAM.
+constexpr std::align_val_t kPMEMLineAlign{kPMEMLineSize};
+
+/// @brief Permission for creating pools.
+constexpr mode_t kModeRW = S_IRUSR | S_IWUSR;
+
+/// @brief The argument value for placing target words on DRAM.
+constexpr int64_t kDRAM = 0;
+
+/// @brief The argument value for placing target words on PMEM.
+constexpr int64_t kPMEM = 1;
+
+/// @brief Zipf skew parameters (multiplied by 100) for benchmarks.
+const std::vector<int64_t> kSkews = {0, 50, 99, 120};
+
+/// @brief The number of keys in a persistent list.
+/// @note A list is traversed linearly, so this should be small.
+constexpr size_t kListKeyNum = 1024;
+
+/// @brief The maximum number of values in a persistent ring buffer.
+constexpr size_t kRingCapacity = 1024;
+
+/// @brief Ratios of updates (in percent) for list benchmarks.
+const std::vector<int64_t> kUpdateRatios = {0, 50, 100};
+
+static_assert(PersistentList::GetRegionSize(kListKeyNum) <= kWordNum * kWordSize);
+static_assert(PersistentRingBuffer::GetRegionSize(kRingCapacity) <= kWordNum * kWordSize);
+
+/*##############################################################################
+ * Local utility classes
+ *############################################################################*/
+
+/**
+ * @brief Target words and a descriptor pool shared by benchmark threads.
+ *
+ */
+class BenchTarget
+{
+ public:
+  /*############################################################################
+   * Public constructors and assignment operators
+   *##########################################################################*/
+
+  /**
+   * @param on_pmem A flag for placing target words and descriptors on PMEM.
+   * @param skew A skew parameter of a Zipf distribution.
+   */
+  BenchTarget(  //
+      const bool on_pmem,
+      const double skew)
+      : zipf_{kWordNum, skew}
+  {
+    constexpr size_t kWordsSize = kWordNum * kWordSize;
+
+    if (on_pmem) {
+      word_path_ = GetPoolPath(kWordLayout);
+      desc_path_ = GetPoolPath(kDescLayout);
+      std::filesystem::create_directories(kTmpPMEMPath);
+      std::filesystem::remove(word_path_);
+      std::filesystem::remove(desc_path_);
+
+      const auto pool_size = kWordsSize + 2 * PMEMOBJ_MIN_POOL;
+      pop_ = pmemobj_create(word_path_.c_str(), kWordLayout, pool_size, kModeRW);
+      if (pop_ == nullptr) throw std::runtime_error{pmemobj_errormsg()};
+      words_ = static_cast<uint64_t *>(pmemobj_direct(pmemobj_root(pop_, kWordsSize)));
+      pool_ = std::make_unique<DescriptorPool>(desc_path_, kDescLayout);
+    } else {
+      words_ = static_cast<uint64_t *>(::operator new(kWordsSize, kPMEMLineAlign));
+      pool_ = std::make_unique<DescriptorPool>(kVolatile);
+    }
+    std::memset(static_cast<void *>(words_), 0, kWordsSize);
+  }
+
+  BenchTarget(const BenchTarget &) = delete;
+  BenchTarget(BenchTarget &&) = delete;
+
+  auto operator=(const BenchTarget &) -> BenchTarget & = delete;
+  auto operator=(BenchTarget &&) -> BenchTarget & = delete;
+
+  /*############################################################################
+   * Public destructors
+   *##########################################################################*/
+
+  ~BenchTarget()
+  {
+    pool_.reset();
+    if (pop_ != nullptr) {
+      pmemobj_close(pop_);
+      std::filesystem::remove(word_path_);
+      std::filesystem::remove(desc_path_);
+    } else {
+      ::operator delete(static_cast<void *>(words_), kPMEMLineAlign);
+    }
+  }
+
+  /*############################################################################
+   * Public utility functions
+   *##########################################################################*/
+
+  /**
+   * @param i The index of a word.
+   * @return The address of the word.
+   */
+  [[nodiscard]] auto
+  GetWord(  //
+      const size_t i) const  //
+      -> uint64_t *
+  {
+    return &(words_[i]);
+  }
+
+  /**
+   * @return The zero-filled region of target words for containers.
+   */
+  [[nodiscard]] auto
+  GetRegion() const  //
+      -> void *
+  {
+    return words_;
+  }
+
+  /**
+   * @return The descriptor pool shared by benchmark threads.
+   */
+  [[nodiscard]] auto
+  GetPool() const  //
+      -> DescriptorPool &
+  {
+    return *pool_;
+  }
+
+  /**
+   * @return A PMwCAS descriptor for the current thread.
+   */
+  [[nodiscard]] auto
+  GetDescriptor() const  //
+      -> PMwCASDescriptor *
+  {
+    return pool_->Get();
+  }
+
+  /**
+   * @param seed A seed for a random engine.
+   * @return Zipf-distributed indices of target words.
+   */
+  [[nodiscard]] auto
+  GenerateIndices(  //
+      const size_t seed) const  //
+      -> std::vector<size_t>
+  {
+    std::mt19937_64 rand_engine{seed};
+    std::vector<size_t> indices{};
+    indices.reserve(kIndexNum);
+    for (size_t i = 0; i < kIndexNum; ++i) {
+      indices.emplace_back(zipf_(rand_engine));
+    }
+    return indices;
+  }
+
+ private:
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  /**
+   * @param name The name of a pool.
+   * @return The path to the pool on a persistent storage.
+   */
+  static auto
+  GetPoolPath(  //
+      const std::string_view name)  //
+      -> std::filesystem::path
+  {
+    std::filesystem::path path{kTmpPMEMPath};
+    path /= name;
+    return path;
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief A Zipf distribution for selecting target words.
+  ZipfDistribution zipf_;
+
+  /// @brief A pmemobj pool for target words (null if on DRAM).
+  PMEMobjpool *pop_{nullptr};
+
+  /// @brief The head of target words.
+  uint64_t *words_{nullptr};
+
+  /// @brief A descriptor pool for PMwCAS.
+  std::unique_ptr<DescriptorPool> pool_{nullptr};
+
+  /// @brief The path to a pool for target words.
+  std::filesystem::path word_path_{};
+
+  /// @brief The path to a pool for PMwCAS descriptors.
+  std::filesystem::path desc_path_{};
+};
+
+/*##############################################################################
+ * Local variables
+ *############################################################################*/
+
+/// @brief The target of the running benchmark.
+std::unique_ptr<BenchTarget> target{nullptr};
+
+/// @brief A persistent list on the target words.
+std::unique_ptr<PersistentList> list{nullptr};
+
+/// @brief A persistent ring buffer on the target words.
+std::unique_ptr<PersistentRingBuffer> ring{nullptr};
+
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+void
+SetUpTarget(  //
+    const ::benchmark::State &state)
+{
+  const auto on_pmem = state.range(0) == kPMEM;
+  if (on_pmem && kTmpPMEMPath.empty()) return;
+  target = std::make_unique<BenchTarget>(on_pmem, static_cast<double>(state.range(1)) / 100);
+}
+
+void
+SetUpList(  //
+    const ::benchmark::State &state)
+{
+  SetUpTarget(state);
+  if (!target || target->GetPool().GetCapacity() < 5) return;
+
+  list = std::make_unique<PersistentList>(target->GetRegion(), kListKeyNum, target->GetPool());
+  for (size_t key = 0; key < kListKeyNum; ++key) {
+    list->Insert(key, 0);
+  }
+}
+
+void
+SetUpRing(  //
+    const ::benchmark::State &state)
+{
+  SetUpTarget(state);
+  if (!target) return;
+
+  ring = std::make_unique<PersistentRingBuffer>(target->GetRegion(), kRingCapacity,
+                                                target->GetPool());
+}
+
+void
+TearDownTarget(  //
+    const ::benchmark::State &)
+{
+  list.reset();
+  ring.reset();
+  target.reset();
+}
+
+/**
+ * @brief Perform an operation and sample its latency at regular intervals.
+ *
+ * @param i The sequence number of the operation.
+ * @param hist A histogram for recording latency.
+ * @param op The operation to be measured.
+ */
+template <class Operation>
+inline void
+Measure(  //
+    const size_t i,
+    LatencyHistogram &hist,
+    Operation &&op)
+{
+  if (i % kSampleInterval != 0) {
+    op();
+    return;
+  }
+
+  const auto begin = std::chrono::steady_clock::now();
+  op();
+  const auto end = std::chrono::steady_clock::now();
+  hist.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+}
+
+/**
+ * @brief Report throughput, latency quantiles, and the ratio of failures.
+ *
+ * @param state The state of the running benchmark.
+ * @param hist A histogram of latency.
+ * @param fail_num The number of failed operations.
+ */
+void
+Report(  //
+    ::benchmark::State &state,
+    const LatencyHistogram &hist,
+    const size_t fail_num)
+{
+  using ::benchmark::Counter;
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["p50_ns"] = Counter{hist.Quantile(0.5), Counter::kAvgThreads};
+  state.counters["p90_ns"] = Counter{hist.Quantile(0.9), Counter::kAvgThreads};
+  state.counters["p99_ns"] = Counter{hist.Quantile(0.99), Counter::kAvgThreads};
+  state.counters["p999_ns"] = Counter{hist.Quantile(0.999), Counter::kAvgThreads};
+  const auto iter_num = std::max<double>(static_cast<double>(state.iterations()), 1);
+  state.counters["fail_ratio"] =
+      Counter{static_cast<double>(fail_num) / iter_num, Counter::kAvgThreads};
+}
+
+/**
+ * @param state The state of the running benchmark.
+ * @retval true if the target has been prepared.
+ * @retval false otherwise.
+ */
+auto
+IsReady(  //
+    ::benchmark::State &state)  //
+    -> bool
+{
+  if (target) return true;
+  state.SkipWithError("DBGROUP_TEST_TMP_PMEM_PATH is not set.");
+  return false;
+}
+
+/*##############################################################################
+ * Benchmark definitions
+ *############################################################################*/
+
+void
+BM_PLoad(  //
+    ::benchmark::State &state)
+{
+  if (!IsReady(state)) return;
+
+  const auto &indices = target->GenerateIndices(state.thread_index());
+  LatencyHistogram hist{};
+  size_t i = 0;
+  for ([[maybe_unused]] auto _ : state) {
+    auto *addr = target->GetWord(indices[i % kIndexNum]);
+    Measure(i++, hist, [addr] {
+      ::benchmark::DoNotOptimize(PLoad(addr, std::memory_order_acquire));
+    });
+  }
+  Report(state, hist, 0);
+}
+
+void
+BM_PCAS(  //
+    ::benchmark::State &state)
+{
+  if (!IsReady(state)) return;
+
+  const auto &indices = target->GenerateIndices(state.thread_index());
+  LatencyHistogram hist{};
+  size_t fail_num = 0;
+  size_t i = 0;
+  for ([[maybe_unused]] auto _ : state) {
+    auto *addr = target->GetWord(indices[i % kIndexNum]);
+    Measure(i++, hist, [addr, &fail_num] {
+      auto cur = PLoad(addr, std::memory_order_relaxed);
+      if (!PCAS(addr, cur, cur + 1, std::memory_order_release)) {
+        ++fail_num;
+      }
+    });
+  }
+  Report(state, hist, fail_num);
+}
+
+void
+BM_PMwCAS(  //
+    ::benchmark::State &state)
+{
+  if (!IsReady(state)) return;
+
+  const auto word_num = static_cast<size_t>(state.range(2));
+  const auto &indices = target->GenerateIndices(state.thread_index());
+  auto *desc = target->GetDescriptor();
+  LatencyHistogram hist{};
+  std::array<uint64_t *, kPMwCASCapacity> addrs{};
+  size_t fail_num = 0;
+  size_t i = 0;
+  size_t j = 0;
+  for ([[maybe_unused]] auto _ : state) {
+    // select distinct target words
+    for (size_t n = 0; n < word_num; ++j) {
+      auto *addr = target->GetWord(indices[j % kIndexNum]);
+      if (std::find(addrs.begin(), addrs.begin() + n, addr) != addrs.begin() + n) continue;
+      addrs[n++] = addr;
+    }
+
+    Measure(i++, hist, [&] {
+      for (size_t n = 0; n < word_num; ++n) {
+        const auto cur = PLoad(addrs[n], std::memory_order_relaxed);
+        desc->Add(addrs[n], cur, cur + 1, std::memory_order_relaxed);
+      }
+      if (!desc->PMwCAS()) {
+        ++fail_num;
+      }
+    });
+  }
+  Report(state, hist, fail_num);
+}
+
+void
+BM_PersistentList(  //
+    ::benchmark::State &state)
+{
+  if (!IsReady(state)) return;
+  if (!list) {
+    state.SkipWithError("PMEM_ATOMIC_PMWCAS_CAPACITY must be at least five.");
+    return;
+  }
+
+  // reads traverse the list by PLoad, and updates swap values by PCAS
+  const auto update_ratio = static_cast<size_t>(state.range(2));
+  const auto &indices = target->GenerateIndices(state.thread_index());
+  LatencyHistogram hist{};
+  size_t fail_num = 0;
+  size_t i = 0;
+  for ([[maybe_unused]] auto _ : state) {
+    const auto key = indices[i % kIndexNum] % kListKeyNum;
+    const auto is_update = i % 100 < update_ratio;
+    Measure(i++, hist, [key, is_update, &fail_num] {
+      uint64_t value = key;
+      const auto found = is_update ? list->Update(key, value) : list->Read(key, value);
+      if (!found) {
+        ++fail_num;
+      }
+      ::benchmark::DoNotOptimize(value);
+    });
+  }
+  Report(state, hist, fail_num);
+}
+
+void
+BM_PersistentRingBuffer(  //
+    ::benchmark::State &state)
+{
+  if (!IsReady(state)) return;
+
+  // each thread pushes and pops a value, both of which are two-word PMwCAS
+  LatencyHistogram hist{};
+  size_t fail_num = 0;
+  size_t i = 0;
+  for ([[maybe_unused]] auto _ : state) {
+    const auto pushed = i;
+    Measure(i++, hist, [pushed, &fail_num] {
+      uint64_t value{};
+      if (!ring->Push(pushed)) {
+        ++fail_num;
+      }
+      if (!ring->Pop(value)) {
+        ++fail_num;
+      }
+      ::benchmark::DoNotOptimize(value);
+    });
+  }
+  Report(state, hist, fail_num);
+}
+
+/*##############################################################################
+ * Benchmark registration
+ *############################################################################*/
+
+/**
+ * @return The maximum number of benchmark threads.
+ */
+auto
+GetMaxThreadNum()  //
+    -> int
+{
+  const auto hw_num = static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1U));
+  return static_cast<int>(std::min(hw_num, ::dbgroup::thread::kMaxThreadNum));
+}
+
+void
+ApplyCommonArgs(  //
+    ::benchmark::internal::Benchmark *bench)
+{
+  bench->ArgNames({"pmem", "skew"})
+      ->ArgsProduct({{kDRAM, kPMEM}, kSkews})
+      ->ThreadRange(1, GetMaxThreadNum())
+      ->UseRealTime()
+      ->Setup(SetUpTarget)
+      ->Teardown(TearDownTarget);
+}
+
+void
+ApplyPMwCASArgs(  //
+    ::benchmark::internal::Benchmark *bench)
+{
+  bench->ArgNames({"pmem", "skew", "words"})
+      ->ArgsProduct({{kDRAM, kPMEM}, kSkews, ::benchmark::CreateDenseRange(1, kPMwCASCapacity, 1)})
+      ->ThreadRange(1, GetMaxThreadNum())
+      ->UseRealTime()
+      ->Setup(SetUpTarget)
+      ->Teardown(TearDownTarget);
+}
+
+void
+ApplyListArgs(  //
+    ::benchmark::internal::Benchmark *bench)
+{
+  bench->ArgNames({"pmem", "skew", "update"})
+      ->ArgsProduct({{kDRAM, kPMEM}, kSkews, kUpdateRatios})
+      ->ThreadRange(1, GetMaxThreadNum())
+      ->UseRealTime()
+      ->Setup(SetUpList)
+      ->Teardown(TearDownTarget);
+}
+
+void
+ApplyRingArgs(  //
+    ::benchmark::internal::Benchmark *bench)
+{
+  bench->ArgNames({"pmem", "skew"})
+      ->ArgsProduct({{kDRAM, kPMEM}, {0}})
+      ->ThreadRange(1, GetMaxThreadNum())
+      ->UseRealTime()
+      ->Setup(SetUpRing)
+      ->Teardown(TearDownTarget);
+}
+
+BENCHMARK(BM_PLoad)->Apply(ApplyCommonArgs);
+BENCHMARK(BM_PCAS)->Apply(ApplyCommonArgs);
+BENCHMARK(BM_PMwCAS)->Apply(ApplyPMwCASArgs);
+BENCHMARK(BM_PersistentList)->Apply(ApplyListArgs);
+BENCHMARK(BM_PersistentRingBuffer)->Apply(ApplyRingArgs);
+
+}  // namespace
+}  // namespace dbgroup::pmem::atomic::bench
+
+/*##############################################################################
+ * Entry point
+ *############################################################################*/
+
+auto
+main(  //
+    int argc,
+    char **argv)  //
+    -> int
+{
+  using ::dbgroup::pmem::atomic::kBackOffTime;
+  using ::dbgroup::pmem::atomic::kUseDirtyFlag;
+
+  // record compile-time parameters to compare results of different builds
+  ::benchmark::AddCustomContext("pmem_atomic_use_dirty_flag", kUseDirtyFlag ? "ON" : "OFF");
+  ::benchmark::AddCustomContext("pmem_atomic_backoff_time_us",
+                                std::to_string(kBackOffTime.count()));
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  ::benchmark::RunSpecifiedBenchmarks();
+  ::benchmark::Shutdown();
+  return 0;
+}
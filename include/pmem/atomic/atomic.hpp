@@ -24,19 +24,105 @@
 #include <memory>
 #include <type_traits>
 
-// external system libraries
-#include <libpmem.h>
-
 // local sources
+#include "pmem/atomic/component/backoff.hpp"
 #include "pmem/atomic/component/common.hpp"
+#include "pmem/atomic/component/group_commit.hpp"
+#include "pmem/atomic/component/stats.hpp"
 
 namespace dbgroup::pmem::atomic
 {
+/*##############################################################################
+ * Back-off policies
+ *############################################################################*/
+
+/**
+ * @brief Set a policy for waiting for intermediate states to be resolved.
+ *
+ * This policy is shared by all the threads and used after spinning
+ * PMEM_ATOMIC_SPINLOCK_RETRY_NUM times. Each wait is bounded by
+ * PMEM_ATOMIC_BACKOFF_TIME, and after that, a thread resolves a dirty word by
+ * itself.
+ *
+ * @param policy A back-off policy.
+ * @note Double-width words always use `BackoffPolicy::kSleep`.
+ */
+inline void
+SetBackoffPolicy(  //
+    const BackoffPolicy policy)
+{
+  component::backoff_policy.store(policy, std::memory_order_relaxed);
+}
+
+/**
+ * @return The current back-off policy.
+ */
+inline auto
+GetBackoffPolicy()  //
+    -> BackoffPolicy
+{
+  return component::backoff_policy.load(std::memory_order_relaxed);
+}
+
+/*##############################################################################
+ * Group commits
+ *############################################################################*/
+
+/**
+ * @brief Start a group commit in the current thread.
+ *
+ * Until the group commit ends, PCAS and PMwCAS operations in this thread only
+ * flush their updates, and Commit guarantees the durability of all of them.
+ * Words updated by PCAS keep their dirty flags until they are committed, so
+ * other threads never read unpersisted values.
+ *
+ * @note PMwCAS operations still drain their descriptors before embedding and
+ * updating targets for crash consistency, and only their final drains are
+ * deferred. Buffered descriptors must not be released before commit.
+ */
+inline void
+BeginGroupCommit()
+{
+  component::tls_group_commit.SetActive(true);
+}
+
+/**
+ * @brief Persist all the updates of the current thread since the last commit.
+ *
+ */
+inline void
+Commit()
+{
+  component::tls_group_commit.Commit();
+}
+
+/**
+ * @brief Commit the buffered updates and end a group commit.
+ *
+ */
+inline void
+EndGroupCommit()
+{
+  component::tls_group_commit.Commit();
+  component::tls_group_commit.SetActive(false);
+}
+
+/*##############################################################################
+ * Persistent atomic operations
+ *############################################################################*/
+
 /**
  * @tparam T A class of target words.
  * @param addr An address of a target word.
  * @param order A memory barrier for this operation.
  * @return The current value of a given address.
+ * @note If `T` is a 16-byte class, this function uses cmpxchg16b. In this case,
+ * a target word must be aligned to 16 bytes, and the top bit of its last eight
+ * bytes must be reserved as a dirty flag and initialized by zero.
+ * @note x86-64 has no atomic 16-byte load, so every read of a 16-byte word is
+ * a locked cmpxchg16b that writes the current value back. Such reads take the
+ * cache line exclusively and contend with each other like writes, so read-mostly
+ * data should not be stored in double-width words.
  */
 template <class T>
 inline auto
@@ -45,19 +131,59 @@ PLoad(  //
     const std::memory_order order = std::memory_order_seq_cst)  //
     -> T
 {
-  auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
-  auto word = word_addr->load(order);
-  component::ResolveIntermediateState(word_addr, word);
-
-  if constexpr (std::is_same_v<T, uint64_t>) {
-    return word;
-  } else if constexpr (std::is_pointer_v<T>) {
-    return reinterpret_cast<T>(word);
-  } else {
+  if constexpr (sizeof(T) == kWideWordSize) {
+    // double-width words are always read with full barriers
+    const auto word = component::LoadWideWord(static_cast<void *>(addr));
     T ret;
-    std::memcpy(static_cast<void *>(&ret), &word, kWordSize);
+    std::memcpy(static_cast<void *>(&ret), &word, kWideWordSize);
     return ret;
+  } else {
+    auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
+    auto word = word_addr->load(order);
+    component::ResolveIntermediateState(word_addr, word);
+
+    if constexpr (std::is_same_v<T, uint64_t>) {
+      return word;
+    } else if constexpr (std::is_pointer_v<T>) {
+      return reinterpret_cast<T>(word);
+    } else {
+      T ret;
+      std::memcpy(static_cast<void *>(&ret), &word, kWordSize);
+      return ret;
+    }
+  }
+}
+
+/**
+ * @brief Read the logical value of a word without writing to persistent memory.
+ *
+ * Unlike `PLoad`, this function never persists dirty words nor completes
+ * PMwCAS operations on behalf of other threads. A dirty flag is masked, and
+ * the value of an embedded PMwCAS descriptor is read from the descriptor.
+ *
+ * @tparam T A class of target words.
+ * @param addr An address of a target word.
+ * @param order A memory barrier for this operation.
+ * @return The current logical value of a given address.
+ * @note The returned value is visible to other threads but may not be durable
+ * yet, so do not use this function if a subsequent update depends on the
+ * durability of the read value.
+ */
+template <class T>
+inline auto
+PLoadReadOnly(  //
+    const T *addr,
+    const std::memory_order order = std::memory_order_seq_cst)  //
+    -> T
+{
+  static_assert(component::IsAtomic<T>());
+
+  const auto *word_addr = reinterpret_cast<const std::atomic_uint64_t *>(addr);
+  auto word = word_addr->load(order);
+  if (word & kIsIntermediate) {
+    component::ReadLogicalValue(word_addr, word);
   }
+  return component::FromUInt64<T>(word);
 }
 
 /**
@@ -69,6 +195,9 @@ PLoad(  //
  * @param[in] failure A memory barrier in case CAS fails.
  * @retval true if this PCAS operation succeeds.
  * @retval false otherwise.
+ * @note If `T` is a 16-byte class, this function uses cmpxchg16b. In this case,
+ * a target word must be aligned to 16 bytes, and the top bit of its last eight
+ * bytes must be reserved as a dirty flag and initialized by zero.
  */
 template <class T>
 inline auto
@@ -82,36 +211,53 @@ PCAS(  //
 {
   constexpr auto kMORelax = std::memory_order_relaxed;
 
-  uint64_t uint_exp;
-  uint64_t uint_des;
-  if constexpr (std::is_pointer_v<T>) {
-    uint_exp = reinterpret_cast<uint64_t>(expected);
-    uint_des = reinterpret_cast<uint64_t>(desired);
+  if constexpr (sizeof(T) == kWideWordSize) {
+    // double-width words are always swapped with full barriers
+    component::WideWord wide_exp;
+    component::WideWord wide_des;
+    std::memcpy(static_cast<void *>(&wide_exp), &expected, kWideWordSize);
+    std::memcpy(static_cast<void *>(&wide_des), &desired, kWideWordSize);
+    if (component::CASWideWord(static_cast<void *>(addr), wide_exp, wide_des)) {
+      component::CountEvent(StatEvent::kPCAS);
+      return true;
+    }
+    std::memcpy(static_cast<void *>(&expected), &wide_exp, kWideWordSize);
+    component::CountEvent(StatEvent::kPCASFailure);
+    return false;
   } else {
-    std::memcpy(static_cast<void *>(&uint_exp), &expected, kWordSize);
-    std::memcpy(static_cast<void *>(&uint_des), &desired, kWordSize);
-  }
-
-  const auto orig_expected = uint_exp;
-  auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
-  auto dirty_v = uint_des | kDirtyFlag;
-  while (!word_addr->compare_exchange_weak(uint_exp, dirty_v, kMORelax, failure)) {
-    if (uint_exp & kDirtyFlag) {
-      component::ResolveIntermediateState(word_addr, uint_exp);
+    uint64_t uint_exp;
+    uint64_t uint_des;
+    if constexpr (std::is_pointer_v<T>) {
+      uint_exp = reinterpret_cast<uint64_t>(expected);
+      uint_des = reinterpret_cast<uint64_t>(desired);
+    } else {
+      std::memcpy(static_cast<void *>(&uint_exp), &expected, kWordSize);
+      std::memcpy(static_cast<void *>(&uint_des), &desired, kWordSize);
     }
-    if (uint_exp != orig_expected) {
-      if constexpr (std::is_pointer_v<T>) {
-        expected = reinterpret_cast<T>(uint_exp);
-      } else {
-        std::memcpy(static_cast<void *>(&expected), &uint_exp, kWordSize);
+
+    const auto orig_expected = uint_exp;
+    auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
+    const auto new_v = kUseDirtyFlag ? uint_des | kDirtyFlag : uint_des;
+    const auto cas_order = kUseDirtyFlag ? kMORelax : success;
+    while (!word_addr->compare_exchange_weak(uint_exp, new_v, cas_order, failure)) {
+      if (uint_exp & kDirtyFlag) {
+        component::ResolveIntermediateState(word_addr, uint_exp);
+      }
+      if (uint_exp != orig_expected) {
+        if constexpr (std::is_pointer_v<T>) {
+          expected = reinterpret_cast<T>(uint_exp);
+        } else {
+          std::memcpy(static_cast<void *>(&expected), &uint_exp, kWordSize);
+        }
+        component::CountEvent(StatEvent::kPCASFailure);
+        return false;
       }
-      return false;
     }
-  }
 
-  pmem_persist(addr, kWordSize);
-  word_addr->compare_exchange_strong(dirty_v, uint_des, success, kMORelax);
-  return true;
+    component::PersistWord(word_addr, new_v, success);
+    component::CountEvent(StatEvent::kPCAS);
+    return true;
+  }
 }
 
 /**
@@ -138,6 +284,187 @@ PCAS(  //
                                                    : order);
 }
 
+/**
+ * @brief Read a consistent snapshot of multiple words without descriptors.
+ *
+ * This function reads all the words twice (i.e., double collect) and retries
+ * until the second read returns the same values as the first one. Since an
+ * embedded descriptor has a different value from any resolved word, the
+ * returned values have been held by the words at the same time unless a word
+ * has returned to a previous value between the two reads (i.e., the ABA
+ * problem). Use monotonic values such as version counters to guarantee
+ * linearizable snapshots.
+ *
+ * @tparam T A class of target words.
+ * @param[in] addrs The addresses of target words.
+ * @param[out] values The buffer for storing the read values.
+ * @param[in] num The number of target words.
+ * @note Each word is read with acquire loads, and this function may not
+ * return while the words are frequently updated.
+ */
+template <class T>
+inline void
+PMwRead(  //
+    T *const addrs[],
+    T values[],
+    const size_t num)
+{
+  static_assert(component::IsAtomic<T>());
+
+  while (true) {
+    // the first collect resolves intermediate states
+    for (size_t i = 0; i < num; ++i) {
+      auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addrs[i]);
+      auto word = word_addr->load(std::memory_order_acquire);
+      component::ResolveIntermediateState(word_addr, word);
+      values[i] = component::FromUInt64<T>(word);
+    }
+
+    // the second collect validates that no word has been modified
+    auto consistent = true;
+    for (size_t i = 0; i < num && consistent; ++i) {
+      const auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addrs[i]);
+      consistent = word_addr->load(component::kMORelax) == component::ToUInt64(values[i]);
+    }
+    if (consistent) return;
+  }
+}
+
+/*##############################################################################
+ * Persistent read-modify-write operations
+ *############################################################################*/
+
+/**
+ * @brief Persistently add a given value to a target word.
+ *
+ * @tparam T A class of target words (only `uint64_t` is allowed).
+ * @param addr An address of a target word.
+ * @param val A value to be added.
+ * @param order A memory barrier for this operation.
+ * @return The previous value of the word.
+ * @note If PMEM_ATOMIC_USE_DIRTY_FLAG is disabled, this operation is performed
+ * by a single RMW instruction, so a target word must not be a PMwCAS target.
+ * Otherwise, it is performed by a CAS loop to set a dirty flag.
+ */
+template <class T>
+inline auto
+PFetchAdd(  //
+    T *addr,
+    const T val,
+    const std::memory_order order = std::memory_order_seq_cst)  //
+    -> T
+{
+  static_assert(std::is_same_v<T, uint64_t>);
+
+  auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
+  if constexpr (kUseDirtyFlag) {
+    return component::FetchUpdate(word_addr, [val](const uint64_t w) { return w + val; }, order);
+  } else {
+    const auto old_v = word_addr->fetch_add(val, order);
+    component::PersistWord(word_addr, old_v + val, order);
+    return old_v;
+  }
+}
+
+/**
+ * @brief Persistently swap a target word for a given value.
+ *
+ * @tparam T A class of target words.
+ * @param addr An address of a target word.
+ * @param desired A desired value.
+ * @param order A memory barrier for this operation.
+ * @return The previous value of the word.
+ * @note If PMEM_ATOMIC_USE_DIRTY_FLAG is disabled, this operation is performed
+ * by a single RMW instruction, so a target word must not be a PMwCAS target.
+ * Otherwise, it is performed by a CAS loop to set a dirty flag.
+ */
+template <class T>
+inline auto
+PExchange(  //
+    T *addr,
+    const T desired,
+    const std::memory_order order = std::memory_order_seq_cst)  //
+    -> T
+{
+  static_assert(component::IsAtomic<T>());
+
+  auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
+  const auto new_v = component::ToUInt64(desired);
+  if constexpr (kUseDirtyFlag) {
+    const auto old_v =
+        component::FetchUpdate(word_addr, [new_v](const uint64_t) { return new_v; }, order);
+    return component::FromUInt64<T>(old_v);
+  } else {
+    const auto old_v = word_addr->exchange(new_v, order);
+    component::PersistWord(word_addr, new_v, order);
+    return component::FromUInt64<T>(old_v);
+  }
+}
+
+/**
+ * @brief Persistently apply bitwise OR to a target word.
+ *
+ * @tparam T A class of target words (only `uint64_t` is allowed).
+ * @param addr An address of a target word.
+ * @param val A bit pattern to be set.
+ * @param order A memory barrier for this operation.
+ * @return The previous value of the word.
+ * @note If PMEM_ATOMIC_USE_DIRTY_FLAG is disabled, this operation is performed
+ * by a single RMW instruction, so a target word must not be a PMwCAS target.
+ * Otherwise, it is performed by a CAS loop to set a dirty flag.
+ */
+template <class T>
+inline auto
+PFetchOr(  //
+    T *addr,
+    const T val,
+    const std::memory_order order = std::memory_order_seq_cst)  //
+    -> T
+{
+  static_assert(std::is_same_v<T, uint64_t>);
+
+  auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
+  if constexpr (kUseDirtyFlag) {
+    return component::FetchUpdate(word_addr, [val](const uint64_t w) { return w | val; }, order);
+  } else {
+    const auto old_v = word_addr->fetch_or(val, order);
+    component::PersistWord(word_addr, old_v | val, order);
+    return old_v;
+  }
+}
+
+/**
+ * @brief Persistently apply bitwise AND to a target word.
+ *
+ * @tparam T A class of target words (only `uint64_t` is allowed).
+ * @param addr An address of a target word.
+ * @param val A bit mask to be applied.
+ * @param order A memory barrier for this operation.
+ * @return The previous value of the word.
+ * @note If PMEM_ATOMIC_USE_DIRTY_FLAG is disabled, this operation is performed
+ * by a single RMW instruction, so a target word must not be a PMwCAS target.
+ * Otherwise, it is performed by a CAS loop to set a dirty flag.
+ */
+template <class T>
+inline auto
+PFetchAnd(  //
+    T *addr,
+    const T val,
+    const std::memory_order order = std::memory_order_seq_cst)  //
+    -> T
+{
+  static_assert(std::is_same_v<T, uint64_t>);
+
+  auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
+  if constexpr (kUseDirtyFlag) {
+    return component::FetchUpdate(word_addr, [val](const uint64_t w) { return w & val; }, order);
+  } else {
+    const auto old_v = word_addr->fetch_and(val, order);
+    component::PersistWord(word_addr, old_v & val, order);
+    return old_v;
+  }
+}
+
 }  // namespace dbgroup::pmem::atomic
 
 #endif  // PMEM_ATOMIC_ATOMIC_HPP
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_COMPONENT_BACKOFF_HPP
+#define PMEM_ATOMIC_COMPONENT_BACKOFF_HPP
+
+// C++ standard libraries
+#include <atomic>
+#include <cstdint>
+
+// local sources
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+/*##############################################################################
+ * Global variables
+ *############################################################################*/
+
+/// @brief The current policy for waiting for intermediate states.
+inline std::atomic<BackoffPolicy> backoff_policy{BackoffPolicy::kSleep};
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+/**
+ * @brief Wait for a given word to be modified by other threads.
+ *
+ * This function returns when the word may have been modified or a back-off
+ * time has elapsed, so the caller must reload the word.
+ *
+ * @param word_addr An address of a target word.
+ * @param word The current value of the word.
+ * @note If the processor does not support umonitor/umwait, `kWaitPkg` behaves
+ * in the same way as `kPause`.
+ */
+void Backoff(  //
+    const std::atomic_uint64_t *word_addr,
+    uint64_t word);
+
+/**
+ * @brief Wake up threads waiting on a given word by futexes.
+ *
+ * @param word_addr An address of a resolved word.
+ */
+void WakeFutexWaiters(  //
+    const std::atomic_uint64_t *word_addr);
+
+/**
+ * @brief Notify threads waiting for a given word that it has been resolved.
+ *
+ * This function does nothing unless the futex-based policy is used.
+ *
+ * @param word_addr An address of a resolved word.
+ */
+inline void
+WakeWaiters(  //
+    const std::atomic_uint64_t *word_addr)
+{
+  if (backoff_policy.load(std::memory_order_relaxed) != BackoffPolicy::kFutex) return;
+  WakeFutexWaiters(word_addr);
+}
+
+}  // namespace dbgroup::pmem::atomic::component
+
+#endif  // PMEM_ATOMIC_COMPONENT_BACKOFF_HPP
@@ -19,10 +19,14 @@
 
 // C++ standard libraries
 #include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <type_traits>
 
 // local sources
+#include "pmem/atomic/component/backoff.hpp"
+#include "pmem/atomic/component/group_commit.hpp"
+#include "pmem/atomic/component/persist.hpp"
 #include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic::component
@@ -35,15 +39,22 @@ namespace dbgroup::pmem::atomic::component
  * @brief The progress states of PMwCAS operations.
  *
  */
-enum DescStatus {
+enum DescStatus : uint64_t {
   kCompleted = 0,
   kFailed,
   kSucceeded,
+  kUndecided,
 };
 
 /// @brief An alias of std::memory_order_relaxed.
 constexpr std::memory_order kMORelax = std::memory_order_relaxed;
 
+/// @brief A double-width word for PCAS.
+using WideWord = unsigned __int128;
+
+/// @brief A flag for indicating dirty double-width words (the top bit).
+constexpr WideWord kWideDirtyFlag = static_cast<WideWord>(kDirtyFlag) << 64U;
+
 /*##############################################################################
  * Internal utilities
  *############################################################################*/
@@ -51,6 +62,10 @@ constexpr std::memory_order kMORelax = std::memory_order_relaxed;
 /**
  * @brief Persist a given value if it includes a dirty flag.
  *
+ * If PMEM_ATOMIC_HELP_PMWCAS is enabled and a given word has an embedded PMwCAS
+ * descriptor, this function helps the PMwCAS operation to complete instead of
+ * sleeping.
+ *
  * @param[in] word_addr An address of a target word.
  * @param[in,out] word A word that may be dirty.
  */
@@ -58,6 +73,112 @@ void ResolveIntermediateState(  //
     std::atomic_uint64_t *word_addr,
     uint64_t &word);
 
+/**
+ * @brief Get the logical value of a given word without writing anything.
+ *
+ * A dirty flag is masked, and the value of an embedded PMwCAS descriptor is
+ * read from the descriptor instead of completing the operation.
+ *
+ * @param[in] word_addr An address of a target word.
+ * @param[in,out] word A word that may be in an intermediate state.
+ * @note The returned value may not be persisted yet.
+ * @note A descriptor left unrecovered in a lazily opened pool is recovered
+ * before reading since its address may be stale.
+ */
+void ReadLogicalValue(  //
+    const std::atomic_uint64_t *word_addr,
+    uint64_t &word);
+
+/**
+ * @brief Read a double-width word and persist it if it is dirty.
+ *
+ * @param addr An address of a target word aligned to 16 bytes.
+ * @return The clean value of the word.
+ */
+auto LoadWideWord(  //
+    void *addr)     //
+    -> WideWord;
+
+/**
+ * @brief Perform PCAS for a double-width word by using cmpxchg16b.
+ *
+ * @param[in] addr An address of a target word aligned to 16 bytes.
+ * @param[in,out] expected An expected value.
+ * @param[in] desired A desired value.
+ * @retval true if this PCAS operation succeeds.
+ * @retval false otherwise.
+ * @note This operation always acts as a full memory barrier.
+ */
+auto CASWideWord(  //
+    void *addr,
+    WideWord &expected,
+    WideWord desired)  //
+    -> bool;
+
+/**
+ * @brief Persist an updated word and clear its dirty flag if needed.
+ *
+ * In a group commit, this function only flushes the word and defers the rest
+ * until commit.
+ *
+ * @param word_addr An address of an updated word.
+ * @param word The written value, which has a dirty flag if enabled.
+ * @param order A memory barrier for clearing the dirty flag.
+ */
+inline void
+PersistWord(  //
+    std::atomic_uint64_t *word_addr,
+    uint64_t word,
+    const std::memory_order order)
+{
+  if (tls_group_commit.IsActive()) {
+    if constexpr (kUseDirtyFlag) {
+      tls_group_commit.AddDirtyWord(word_addr, word);
+      std::atomic_thread_fence(order);
+    } else {
+      Flush(word_addr, kWordSize);
+    }
+    return;
+  }
+
+  Persist(word_addr, kWordSize);
+  if constexpr (kUseDirtyFlag) {
+    word_addr->compare_exchange_strong(word, word & ~kDirtyFlag, order, kMORelax);
+    WakeWaiters(word_addr);
+  }
+}
+
+/**
+ * @brief Update a word by using a given function and persist it.
+ *
+ * This function waits for intermediate states to be resolved, and then writes
+ * an updated value with a dirty flag by using a CAS loop.
+ *
+ * @tparam Func A class of update functions.
+ * @param word_addr An address of a target word.
+ * @param update A function to compute a new value from the current one.
+ * @param order A memory barrier for this operation.
+ * @return The previous value of the word.
+ */
+template <class Func>
+inline auto
+FetchUpdate(  //
+    std::atomic_uint64_t *word_addr,
+    Func &&update,
+    const std::memory_order order)  //
+    -> uint64_t
+{
+  auto word = word_addr->load(kMORelax);
+  while (true) {
+    ResolveIntermediateState(word_addr, word);
+    const auto dirty_v = update(word) | kDirtyFlag;
+    if (word_addr->compare_exchange_weak(word, dirty_v, kMORelax, kMORelax)) {
+      PersistWord(word_addr, dirty_v, order);
+      return word;
+    }
+  }
+}
+
 /**
  * @tparam T A target class.
  * @retval true if a given class is atomically modifiable.
@@ -97,6 +218,28 @@ ToUInt64(   //
   }
 }
 
+/**
+ * @tparam T A target class.
+ * @param word An unsigned integer to be converted.
+ * @return A converted object.
+ */
+template <class T>
+auto
+FromUInt64(  //
+    const uint64_t word)  //
+    -> T
+{
+  if constexpr (std::is_same_v<T, uint64_t>) {
+    return word;
+  } else if constexpr (std::is_pointer_v<T>) {
+    return reinterpret_cast<T>(word);
+  } else {
+    T ret;
+    std::memcpy(static_cast<void *>(&ret), &word, kWordSize);
+    return ret;
+  }
+}
+
 }  // namespace dbgroup::pmem::atomic::component
 
 #endif  // PMEM_ATOMIC_COMPONENT_COMMON_HPP
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_COMPONENT_CRASH_INJECTION_HPP
+#define PMEM_ATOMIC_COMPONENT_CRASH_INJECTION_HPP
+
+// C++ standard libraries
+#include <cstddef>
+#include <stdexcept>
+
+// local sources
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+/*##############################################################################
+ * Global classes
+ *############################################################################*/
+
+/**
+ * @brief An exception thrown at an injected crash point.
+ *
+ */
+class SimulatedCrash : public std::runtime_error
+{
+ public:
+  /**
+   * @brief Construct a new SimulatedCrash object.
+   *
+   */
+  SimulatedCrash() : std::runtime_error{"a crash is injected at a fence."} {}
+};
+
+/*##############################################################################
+ * Utilities for crash injection
+ *############################################################################*/
+
+/**
+ * @brief Track the durable image of a given region.
+ *
+ * The current contents of the region are treated as durable, and after that,
+ * only cache lines that are flushed and then fenced are reflected to the
+ * durable image.
+ *
+ * @param addr The head address of a target region.
+ * @param size The length of the region in bytes.
+ * @note This function is available only if PMEM_ATOMIC_ENABLE_CRASH_INJECTION
+ * is enabled, and tracked regions must not be modified by other threads.
+ */
+void RegisterCrashRegion(  //
+    void *addr,
+    size_t size);
+
+/**
+ * @brief Inject a crash at a given fence point.
+ *
+ * @param fence_num The number of fences completed before the crash.
+ * @note The current thread throws `SimulatedCrash` instead of performing the
+ * (fence_num + 1)-th fence.
+ */
+void ArmCrash(  //
+    size_t fence_num);
+
+/**
+ * @brief Cancel an injected crash.
+ *
+ * @return The number of fences since the last call of `ArmCrash`.
+ */
+auto DisarmCrash()  //
+    -> size_t;
+
+/**
+ * @brief Overwrite the tracked regions with their durable images.
+ *
+ * This function emulates a restart by dropping all the updates that were not
+ * flushed and fenced, and then stops tracking the regions.
+ */
+void RestoreDurableImage();
+
+/**
+ * @brief Record a flush of a given region.
+ *
+ * @param addr The head address of a flushed region.
+ * @param size The length of the region in bytes.
+ */
+void TraceFlush(  //
+    const void *addr,
+    size_t size);
+
+/**
+ * @brief Record a fence and throw `SimulatedCrash` at the injected point.
+ *
+ */
+void TraceDrain();
+
+}  // namespace dbgroup::pmem::atomic::component
+
+#endif  // PMEM_ATOMIC_COMPONENT_CRASH_INJECTION_HPP
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_COMPONENT_GROUP_COMMIT_HPP
+#define PMEM_ATOMIC_COMPONENT_GROUP_COMMIT_HPP
+
+// C++ standard libraries
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// local sources
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic
+{
+/*##############################################################################
+ * Forward declarations
+ *############################################################################*/
+
+class PMwCASDescriptor;
+
+namespace component
+{
+/**
+ * @brief A class to buffer unpersisted updates of a thread in group commits.
+ *
+ * Words updated by PCAS keep their dirty flags until they are committed, so
+ * other threads can treat them in the same way as usual dirty words.
+ */
+class GroupCommitBuffer
+{
+ public:
+  /*############################################################################
+   * Public constructors and assignment operators
+   *##########################################################################*/
+
+  /**
+   * @brief Construct an inactive buffer.
+   *
+   */
+  constexpr GroupCommitBuffer() = default;
+
+  GroupCommitBuffer(const GroupCommitBuffer &) = delete;
+  GroupCommitBuffer(GroupCommitBuffer &&) = delete;
+
+  auto operator=(const GroupCommitBuffer &) -> GroupCommitBuffer & = delete;
+  auto operator=(GroupCommitBuffer &&) -> GroupCommitBuffer & = delete;
+
+  /*############################################################################
+   * Public destructors
+   *##########################################################################*/
+
+  /**
+   * @brief Destroy the GroupCommitBuffer object.
+   *
+   * If a thread exits in a group commit, its buffered updates are committed
+   * here so that its dirty words and PMwCAS operations are not left forever.
+   * @note The descriptors of the buffered PMwCAS operations must outlive the
+   * thread in this case.
+   */
+  ~GroupCommitBuffer();
+
+  /*############################################################################
+   * Public getters/setters
+   *##########################################################################*/
+
+  /**
+   * @retval true if the current thread is in a group commit.
+   * @retval false otherwise.
+   */
+  [[nodiscard]] constexpr auto
+  IsActive() const  //
+      -> bool
+  {
+    return active_;
+  }
+
+  /**
+   * @param active A flag for starting/stopping a group commit.
+   */
+  constexpr void
+  SetActive(  //
+      const bool active)
+  {
+    active_ = active;
+  }
+
+  /*############################################################################
+   * Public utilities
+   *##########################################################################*/
+
+  /**
+   * @brief Flush a dirty word and defer clearing its dirty flag until commit.
+   *
+   * @param word_addr An address of a dirty word.
+   * @param dirty_word A dirty value written to the word.
+   */
+  void AddDirtyWord(  //
+      std::atomic_uint64_t *word_addr,
+      uint64_t dirty_word);
+
+  /**
+   * @brief Defer finishing a started PMwCAS operation until commit.
+   *
+   * @param desc A descriptor that has a started PMwCAS operation.
+   */
+  void AddDescriptor(  //
+      PMwCASDescriptor *desc);
+
+  /**
+   * @param word_addr An address of a target word.
+   * @param word A dirty value of the word.
+   * @retval true if this buffer has written the given dirty word.
+   * @retval false otherwise.
+   */
+  [[nodiscard]] auto Contains(  //
+      const std::atomic_uint64_t *word_addr,
+      uint64_t word) const  //
+      -> bool;
+
+  /**
+   * @brief Persist all the buffered updates and clear their dirty flags.
+   *
+   */
+  void Commit();
+
+ private:
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief A flag for indicating a group commit is in progress.
+  bool active_{false};
+
+  /// @brief The number of buffered dirty words.
+  size_t word_count_{0};
+
+  /// @brief The number of buffered descriptors.
+  size_t desc_count_{0};
+
+  /// @brief The addresses of buffered dirty words.
+  std::atomic_uint64_t *word_addrs_[kGroupCommitCapacity]{};
+
+  /// @brief The dirty values of buffered words.
+  uint64_t dirty_words_[kGroupCommitCapacity]{};
+
+  /// @brief Descriptors that have started PMwCAS operations.
+  PMwCASDescriptor *descs_[kGroupCommitCapacity]{};
+};
+
+/// @brief The buffer of group commits for each thread.
+inline thread_local GroupCommitBuffer tls_group_commit{};
+
+}  // namespace component
+}  // namespace dbgroup::pmem::atomic
+
+#endif  // PMEM_ATOMIC_COMPONENT_GROUP_COMMIT_HPP
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_COMPONENT_PERSIST_HPP
+#define PMEM_ATOMIC_COMPONENT_PERSIST_HPP
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+
+// external system libraries
+#include <libpmem.h>
+
+// local sources
+#include "pmem/atomic/component/crash_injection.hpp"
+#include "pmem/atomic/component/stats.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+/*##############################################################################
+ * Global enum and constants
+ *############################################################################*/
+
+/**
+ * @brief Instructions for writing back cache lines to persistent memory.
+ *
+ */
+enum class FlushType : uint8_t {
+  /// @brief CPU caches are in the persistence domain (e.g., eADR).
+  kNone = 0,
+  /// @brief Write back cache lines by clwb.
+  kCLWB,
+  /// @brief Write back and invalidate cache lines by clflushopt.
+  kCLFlushOpt,
+  /// @brief Write back and invalidate cache lines by clflush.
+  kCLFlush,
+  /// @brief Delegate flushes to libpmem.
+  kLibPmem,
+};
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+/**
+ * @brief Detect the flush instruction to be used in this process.
+ *
+ * If the environment variable PMEM_NO_FLUSH is set to `1` or the platform has
+ * auto flush (e.g., eADR), flushes are disabled. If PMEM_NO_FLUSH is set to
+ * `0`, flushes are performed even on such platforms.
+ *
+ * @return The detected flush type.
+ */
+auto DetectFlushType()  //
+    -> FlushType;
+
+/**
+ * @return The flush type detected at the first call.
+ */
+inline auto
+GetFlushType()  //
+    -> FlushType
+{
+  static const FlushType flush_type = DetectFlushType();
+  return flush_type;
+}
+
+/**
+ * @brief Write back the cache lines of a given region without fences.
+ *
+ * @param addr The head address of a target region.
+ * @param size The length of the region in bytes.
+ */
+inline void
+Flush(  //
+    const void *addr,
+    const size_t size)
+{
+  if constexpr (kEnableCrashInjection) {
+    TraceFlush(addr, size);
+  }
+
+  const auto type = GetFlushType();
+  if (type == FlushType::kNone) return;
+
+  const auto begin = reinterpret_cast<uintptr_t>(addr) & ~(kCacheLineSize - 1);
+  const auto end = reinterpret_cast<uintptr_t>(addr) + size;
+  CountEvent(StatEvent::kFlush, (end - begin + kCacheLineSize - 1) / kCacheLineSize);
+
+#if defined(__x86_64__)
+  switch (type) {
+    case FlushType::kCLWB:
+      for (auto line = begin; line < end; line += kCacheLineSize) {
+        asm volatile("clwb %0" : "+m"(*reinterpret_cast<volatile char *>(line)));
+      }
+      return;
+    case FlushType::kCLFlushOpt:
+      for (auto line = begin; line < end; line += kCacheLineSize) {
+        asm volatile("clflushopt %0" : "+m"(*reinterpret_cast<volatile char *>(line)));
+      }
+      return;
+    case FlushType::kCLFlush:
+      for (auto line = begin; line < end; line += kCacheLineSize) {
+        asm volatile("clflush %0" : "+m"(*reinterpret_cast<volatile char *>(line)));
+      }
+      return;
+    default:
+      break;
+  }
+#endif
+
+  pmem_flush(addr, size);
+}
+
+/**
+ * @brief Wait for preceding flushes to be completed.
+ *
+ */
+inline void
+Drain()
+{
+  if constexpr (kEnableCrashInjection) {
+    TraceDrain();
+  }
+
+  CountEvent(StatEvent::kDrain);
+  switch (GetFlushType()) {
+#if defined(__x86_64__)
+    case FlushType::kCLFlush:
+      // clflush is ordered with respect to stores
+      asm volatile("" ::: "memory");
+      return;
+    case FlushType::kNone:
+    case FlushType::kCLWB:
+    case FlushType::kCLFlushOpt:
+      asm volatile("sfence" ::: "memory");
+      return;
+#endif
+    default:
+      pmem_drain();
+      return;
+  }
+}
+
+/**
+ * @brief Write back the cache lines of a given region and wait for them.
+ *
+ * @param addr The head address of a target region.
+ * @param size The length of the region in bytes.
+ */
+inline void
+Persist(  //
+    const void *addr,
+    const size_t size)
+{
+  Flush(addr, size);
+  Drain();
+}
+
+}  // namespace dbgroup::pmem::atomic::component
+
+#endif  // PMEM_ATOMIC_COMPONENT_PERSIST_HPP
@@ -18,12 +18,11 @@
 #define PMEM_ATOMIC_COMPONENT_PMWCAS_TARGET_HPP
 
 // C++ standard libraries
+#include <atomic>
+#include <cassert>
 #include <cstdint>
 #include <memory>
 
-// external system libraries
-#include <libpmemobj.h>
-
 // local sources
 #include "pmem/atomic/component/common.hpp"
 
@@ -32,6 +31,9 @@ namespace dbgroup::pmem::atomic::component
 /**
  * @brief A class to represent a PMwCAS target.
  *
+ * Each target occupies three words on persistent memory: the virtual address
+ * of a target word with its fence in the alignment bits, an expected value,
+ * and a desired value.
  */
 class PMwCASTarget
 {
@@ -53,6 +55,7 @@ class PMwCASTarget
    * @param addr A target memory address.
    * @param old_val An expected value of the target address.
    * @param new_val An desired value of the target address.
+   * @param fence A flag for controling std::memory_order.
    */
   template <class T>
   PMwCASTarget(  //
@@ -60,12 +63,13 @@ class PMwCASTarget
       const T old_val,
       const T new_val,
       const std::memory_order fence)
-      : oid_{pmemobj_oid(addr)},
+      : addr_{reinterpret_cast<uint64_t>(addr) | static_cast<uint64_t>(fence)},
         old_val_{ToUInt64(old_val)},
-        new_val_{ToUInt64(new_val)},
-        fence_{fence}
+        new_val_{ToUInt64(new_val)}
   {
     static_assert(IsAtomic<T>());
+    static_assert(static_cast<uint64_t>(std::memory_order_seq_cst) <= kFenceMask);
+    assert((reinterpret_cast<uint64_t>(addr) & kFenceMask) == 0);
   }
 
   constexpr PMwCASTarget(const PMwCASTarget &) = default;
@@ -84,63 +88,217 @@ class PMwCASTarget
    */
   ~PMwCASTarget() = default;
 
+  /*############################################################################
+   * Public getters
+   *##########################################################################*/
+
+  /**
+   * @return The virtual address of this target in the process that added it.
+   */
+  [[nodiscard]] auto
+  GetAddr() const  //
+      -> const void *
+  {
+    return GetWordAddr();
+  }
+
+  /**
+   * @param succeeded A flag for indicating the PMwCAS operation has succeeded.
+   * @return The desired value if succeeded or the expected value otherwise.
+   */
+  [[nodiscard]] auto
+  GetValue(  //
+      const bool succeeded) const  //
+      -> uint64_t
+  {
+    return succeeded ? new_val_ : old_val_;
+  }
+
+  /**
+   * @return The current word of this target address.
+   */
+  [[nodiscard]] auto Load() const  //
+      -> uint64_t;
+
   /*############################################################################
    * Public utility functions
    *##########################################################################*/
 
+  /**
+   * @brief Chain another update of the same address to this target.
+   *
+   * The expected value of this target is kept, and the desired value and fence
+   * are overwritten by the given ones.
+   *
+   * @tparam T A class of PMwCAS targets.
+   * @param old_val An expected value of the chained update.
+   * @param new_val An desired value of the chained update.
+   * @param fence A flag for controling std::memory_order.
+   * @note If the expected value of the chained update differs from the desired
+   * value of this target, both updates can never succeed together. In this
+   * case, this target expects a value that no word can have, so the PMwCAS
+   * operation fails and reports this target as a conflict.
+   */
+  template <class T>
+  void
+  Chain(  //
+      const T old_val,
+      const T new_val,
+      const std::memory_order fence)
+  {
+    static_assert(IsAtomic<T>());
+
+    if (ToUInt64(old_val) != new_val_) {
+      old_val_ = kUnsatisfiable;
+    }
+    new_val_ = ToUInt64(new_val);
+    addr_ = (addr_ & ~kFenceMask) | static_cast<uint64_t>(fence);
+  }
+
+  /**
+   * @brief Check the current value of this target without any synchronization.
+   *
+   * @retval true if this target may have the expected value.
+   * @retval false if this target has a different value.
+   * @note An embedded descriptor is treated as the expected value since its
+   * logical value is unknown.
+   */
+  [[nodiscard]] auto MayHaveExpectedValue() const  //
+      -> bool;
+
+  /**
+   * @brief Embed a descriptor into this target address without atomic
+   * instructions.
+   *
+   * @param desc_addr A memory address of a target descriptor.
+   * @retval true if the descriptor address is embedded.
+   * @retval false if this target does not have the expected value.
+   * @note This function must be called in a hardware transaction.
+   */
+  auto EmbedDescriptorInHTM(  //
+      uint64_t desc_addr)     //
+      -> bool;
+
+  /**
+   * @brief Write the desired value into this target address without atomic
+   * instructions.
+   *
+   * @param dirty A flag for setting a dirty flag to the desired value.
+   * @retval true if the desired value is written.
+   * @retval false if this target does not have the expected value.
+   * @note This function must be called in a hardware transaction.
+   */
+  auto UpdateInHTM(  //
+      bool dirty)    //
+      -> bool;
+
+  /**
+   * @brief Clear the dirty flag of the desired value written by UpdateInHTM.
+   *
+   * @param defer A flag for deferring it until the current group commit.
+   */
+  void ClearDirtyFlag(  //
+      bool defer);
+
   /**
    * @brief Embed a descriptor into this target address.
    *
    * @param desc_addr A memory address of a target descriptor.
    * @retval true if the descriptor address is successfully embedded.
    * @retval false otherwise.
+   * @note If PMEM_ATOMIC_HELP_PMWCAS is enabled, helping threads may have
+   * embedded the same descriptor, and this function also returns true.
    */
   auto EmbedDescriptor(    //
       uint64_t desc_addr)  //
       -> bool;
 
-  /**
-   * @brief Flush a value of this target address.
-   *
-   */
-  void Flush();
-
   /**
    * @brief Update a value of this target address.
    *
+   * @param desc_addr A memory address of a target descriptor.
+   * @note This function does not flush the updated value. Callers must flush
+   * the cache line of this target before draining.
+   * @note If PMEM_ATOMIC_HELP_PMWCAS is enabled, the value is updated only if
+   * the target address still has the given descriptor.
    */
-  void Redo();
+  void Redo(  //
+      uint64_t desc_addr);
 
   /**
    * @brief Revert a value of this target address.
    *
+   * @param desc_addr A memory address of a target descriptor.
+   * @note This function does not flush the reverted value. Callers must flush
+   * the cache line of this target before draining.
+   * @note If PMEM_ATOMIC_HELP_PMWCAS is enabled, the value is reverted only if
+   * the target address still has the given descriptor.
    */
-  void Undo();
+  void Undo(  //
+      uint64_t desc_addr);
 
   /**
    * @brief Recover and flush the target.
    *
+   * @param succeeded A flag for indicating the PMwCAS operation has succeeded.
+   * @param desc_addr A memory address of a target descriptor.
+   * @param addr The address of this target in the current process.
+   * @note The stored address is only valid in the process that added this
+   * target, so callers must translate it after restarts.
    */
   void Recover(  //
       bool succeeded,
-      uint64_t desc_addr);
+      uint64_t desc_addr,
+      void *addr) const;
 
  private:
+  /*############################################################################
+   * Internal constants
+   *##########################################################################*/
+
+  /// @brief A mask for extracting fences from the alignment bits of addresses.
+  static constexpr uint64_t kFenceMask = kWordSize - 1;
+
+  /// @brief An expected value that no word can have (i.e., an intermediate
+  /// state without any descriptor).
+  static constexpr uint64_t kUnsatisfiable = kIsIntermediate;
+
+  /*############################################################################
+   * Internal utilities
+   *##########################################################################*/
+
+  /**
+   * @return The virtual address of this target as an atomic word.
+   */
+  [[nodiscard]] auto
+  GetWordAddr() const  //
+      -> std::atomic_uint64_t *
+  {
+    return reinterpret_cast<std::atomic_uint64_t *>(addr_ & ~kFenceMask);
+  }
+
+  /**
+   * @return A fence to be inserted when embedding a new value.
+   */
+  [[nodiscard]] auto
+  GetFence() const  //
+      -> std::memory_order
+  {
+    return static_cast<std::memory_order>(addr_ & kFenceMask);
+  }
+
   /*############################################################################
    * Internal member variables
    *##########################################################################*/
 
-  /// @brief A target memory address.
-  PMEMoid oid_{};
+  /// @brief A target virtual address with a fence in its alignment bits.
+  uint64_t addr_{static_cast<uint64_t>(std::memory_order_seq_cst)};
 
   /// @brief An expected value of a target field.
   uint64_t old_val_{};
 
   /// @brief An inserting value into a target field.
   uint64_t new_val_{};
-
-  /// @brief A fence to be inserted when embedding a new value.
-  std::memory_order fence_{std::memory_order_seq_cst};
 };
 
 }  // namespace dbgroup::pmem::atomic::component
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_COMPONENT_STATS_HPP
+#define PMEM_ATOMIC_COMPONENT_STATS_HPP
+
+// C++ standard libraries
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// local sources
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+/*##############################################################################
+ * Global enum and constants
+ *############################################################################*/
+
+/**
+ * @brief Operations whose latency is recorded by statistics.
+ *
+ */
+enum class LatencyType : uint8_t {
+  kPMwCAS = 0,
+  kBackoff,
+};
+
+/// @brief The number of operations whose latency is recorded.
+constexpr size_t kLatencyTypeNum = 2;
+
+/// @brief An alias of time points for measuring latency.
+using StatClock = std::chrono::steady_clock;
+
+/*##############################################################################
+ * Global classes
+ *############################################################################*/
+
+/**
+ * @brief Statistics written only by their owner thread.
+ *
+ * Each thread has its own instance aligned to cache lines. Other threads only
+ * read counters, so the owner increments them by plain loads and stores
+ * instead of RMW instructions.
+ */
+struct alignas(kCacheLineSize) ThreadStats {
+  /// @brief The number of each event.
+  std::array<std::atomic_uint64_t, kStatEventNum> counts{};
+
+  /// @brief Histograms of latency for each operation type.
+  std::array<std::array<std::atomic_uint64_t, kLatencyBucketNum>, kLatencyTypeNum> latency{};
+};
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+/**
+ * @return The statistics of the current thread.
+ */
+auto GetLocalStats()  //
+    -> ThreadStats &;
+
+/**
+ * @return The sum of statistics of all the threads since the last reset.
+ */
+auto GetStats()  //
+    -> Stats;
+
+/**
+ * @brief Start counting statistics from zero.
+ *
+ * Per-thread counters are never written by other threads, so this function
+ * keeps the current sums as a baseline for subsequent snapshots.
+ */
+void ResetStats();
+
+/**
+ * @brief Increment a counter owned by the current thread.
+ *
+ * @param counter A target counter.
+ * @param n The number to be added.
+ */
+inline void
+Increment(  //
+    std::atomic_uint64_t &counter,
+    const uint64_t n = 1)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Count an event if PMEM_ATOMIC_ENABLE_STATS is enabled.
+ *
+ * @param event A target event.
+ * @param n The number of events.
+ */
+inline void
+CountEvent(  //
+    [[maybe_unused]] const StatEvent event,
+    [[maybe_unused]] const uint64_t n = 1)
+{
+  if constexpr (kEnableStats) {
+    Increment(GetLocalStats().counts[static_cast<size_t>(event)], n);
+  }
+}
+
+/**
+ * @return The current time if PMEM_ATOMIC_ENABLE_STATS is enabled.
+ */
+inline auto
+StartTimer()  //
+    -> StatClock::time_point
+{
+  if constexpr (kEnableStats) {
+    return StatClock::now();
+  } else {
+    return {};
+  }
+}
+
+/**
+ * @brief Record latency if PMEM_ATOMIC_ENABLE_STATS is enabled.
+ *
+ * @param type A type of a measured operation.
+ * @param begin The time when the operation started.
+ */
+inline void
+RecordLatency(  //
+    [[maybe_unused]] const LatencyType type,
+    [[maybe_unused]] const StatClock::time_point begin)
+{
+  if constexpr (kEnableStats) {
+    const auto nanos = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(StatClock::now() - begin).count());
+    const auto bucket = nanos == 0 ? 0 : 63 - __builtin_clzl(nanos);
+    Increment(GetLocalStats().latency[static_cast<size_t>(type)][bucket]);
+  }
+}
+
+}  // namespace dbgroup::pmem::atomic::component
+
+#endif  // PMEM_ATOMIC_COMPONENT_STATS_HPP
@@ -18,17 +18,49 @@
 #define PMEM_ATOMIC_DESCRIPTOR_POOL_HPP
 
 // C++ standard libraries
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 
 // external system libraries
 #include <libpmemobj.h>
 
+// external libraries
+#include "thread/common.hpp"
+
 // local sources
 #include "pmem/atomic/atomic.hpp"
 #include "pmem/atomic/pmwcas_descriptor.hpp"
 
 namespace dbgroup::pmem::atomic
 {
+/**
+ * @brief A tag for constructing descriptor pools on volatile memory.
+ *
+ */
+struct VolatileTag {
+};
+
+/// @brief A tag for constructing descriptor pools on volatile memory.
+constexpr VolatileTag kVolatile{};
+
+/**
+ * @brief A configuration of thread slots for pools dedicated to a few threads.
+ *
+ */
+struct ThreadSlots {
+  /// @brief The number of threads that use a pool.
+  size_t num{1};
+
+  /// @brief A function that returns the slot of the current thread in [0, num).
+  /// @note If this is empty, thread IDs are used as slots as is, so threads
+  /// with IDs not less than `num` cannot get descriptors.
+  std::function<size_t()> mapper{};
+};
+
 /**
  * @brief A class representing the pool of descriptors.
  *
@@ -45,10 +77,95 @@ class DescriptorPool
    *
    * @param pmem_path The path to a pmemobj pool for PMwCAS.
    * @param layout_name The layout name to distinguish application.
+   * @param capacity The maximum number of targets in each descriptor.
+   * @param lazy_recovery A flag for deferring recovery until descriptors are
+   * used (see below).
+   * @throws std::invalid_argument if the capacity is zero or exceeds
+   * PMEM_ATOMIC_PMWCAS_CAPACITY.
+   * @throws std::runtime_error if the pool cannot be opened or was created
+   * with a different configuration or layout version.
+   * @note Each descriptor only occupies the memory region required by the
+   * given capacity. Use pools with different capacities to perform small and
+   * large PMwCAS operations in one process.
+   * @note If the pool has been closed cleanly, this constructor skips checking
+   * descriptors for recovery.
+   * @note If `lazy_recovery` is true, this constructor only scans the states of
+   * descriptors, and each thread recovers its descriptors at the first `Get`.
+   * Threads that read a word embedded by an unrecovered descriptor recover the
+   * descriptor instead of waiting for it.
    */
   explicit DescriptorPool(  //
       const std::string &pmem_path,
-      const std::string &layout_name = "pmwcas_desc_pool");
+      const std::string &layout_name = "pmwcas_desc_pool",
+      size_t capacity = kPMwCASCapacity,
+      bool lazy_recovery = false);
+
+  /**
+   * @brief Construct a new DescriptorPool object for a given number of threads.
+   *
+   * This pool reserves descriptors only for the given thread slots instead of
+   * DBGROUP_MAX_THREAD_NUM threads, which reduces its PMEM footprint and the
+   * number of descriptors scanned for recovery. This is useful for sharded
+   * systems where each pool is used by a few pinned threads.
+   *
+   * @param pmem_path The path to a pmemobj pool for PMwCAS.
+   * @param slots The number of thread slots and the mapping to them.
+   * @param layout_name The layout name to distinguish application.
+   * @param capacity The maximum number of targets in each descriptor.
+   * @param lazy_recovery A flag for deferring recovery until descriptors are
+   * used.
+   * @throws std::invalid_argument if the number of slots or the capacity is
+   * out of range.
+   * @throws std::runtime_error if the pool cannot be opened or was created
+   * with a different configuration or layout version.
+   */
+  DescriptorPool(  //
+      const std::string &pmem_path,
+      ThreadSlots slots,
+      const std::string &layout_name = "pmwcas_desc_pool",
+      size_t capacity = kPMwCASCapacity,
+      bool lazy_recovery = false);
+
+  /**
+   * @brief Construct a new DescriptorPool object over NUMA-local pools.
+   *
+   * The i-th path must be on the persistent memory of the i-th NUMA node, and
+   * each thread gets descriptors from the pool of the node where it runs.
+   * Threads on other nodes use the first pool.
+   *
+   * @param pmem_paths The paths to pmemobj pools for PMwCAS per NUMA node.
+   * @param layout_name The layout name to distinguish application.
+   * @param capacity The maximum number of targets in each descriptor.
+   * @param lazy_recovery A flag for deferring recovery until descriptors are
+   * used.
+   * @throws std::invalid_argument if no path is given or the capacity is zero
+   * or exceeds PMEM_ATOMIC_PMWCAS_CAPACITY.
+   * @throws std::runtime_error if a pool cannot be opened or was created with
+   * a different configuration or layout version.
+   */
+  explicit DescriptorPool(  //
+      const std::vector<std::string> &pmem_paths,
+      const std::string &layout_name = "pmwcas_desc_pool",
+      size_t capacity = kPMwCASCapacity,
+      bool lazy_recovery = false);
+
+  /**
+   * @brief Construct a new DescriptorPool object on volatile memory.
+   *
+   * Descriptors in this pool are allocated on DRAM and never flushed, so their
+   * PMwCAS targets can be on any memory. This pool does not survive restarts.
+   *
+   * @param tag A tag for selecting volatile memory (i.e., `kVolatile`).
+   * @param capacity The maximum number of targets in each descriptor.
+   * @throws std::invalid_argument if the capacity is zero or exceeds
+   * PMEM_ATOMIC_PMWCAS_CAPACITY.
+   * @note PCAS and PLoad do not know which pool manages a word, so they still
+   * flush dirty words. Volatile targets should be updated only by PMwCAS or
+   * wrapped by `PAtomic` without dirty flags.
+   */
+  explicit DescriptorPool(  //
+      VolatileTag tag,
+      size_t capacity = kPMwCASCapacity);
 
   DescriptorPool(const DescriptorPool &) = delete;
   DescriptorPool(DescriptorPool &&) = delete;
@@ -63,31 +180,227 @@ class DescriptorPool
   /**
    * @brief Destroy the DescriptorPool object.
    *
+   * If no descriptor in a pool has a started PMwCAS operation, this destructor
+   * marks the pool as cleanly closed.
    */
   ~DescriptorPool();
 
+  /*############################################################################
+   * Public getters
+   *##########################################################################*/
+
+  /**
+   * @return The maximum number of targets in each descriptor.
+   */
+  [[nodiscard]] constexpr auto
+  GetCapacity() const  //
+      -> size_t
+  {
+    return capacity_;
+  }
+
+  /**
+   * @return The number of thread slots in this pool.
+   */
+  [[nodiscard]] constexpr auto
+  GetSlotNum() const  //
+      -> size_t
+  {
+    return slot_num_;
+  }
+
   /*############################################################################
    * Public utility functions
    *##########################################################################*/
 
   /**
-   * @return The PMwCAS descriptor for the current thread.
-   * @note If a thread calls this function multiple times, it will return the
-   * same descriptor.
+   * @param k The index of a descriptor in the current thread's ring.
+   * @return The k-th PMwCAS descriptor for the current thread.
+   * @note If a thread calls this function multiple times with the same index,
+   * it will return the same descriptor unless the thread migrates to another
+   * NUMA node in the multi-pool mode. Each thread can use
+   * PMEM_ATOMIC_DESCRIPTOR_NUM_PER_THREAD descriptors, so it can prepare the
+   * next PMwCAS operation while the previous one is not finished.
+   * @throws std::out_of_range if the slot of the current thread is out of the
+   * thread slots of this pool.
    */
-  auto Get()  //
+  auto Get(  //
+      size_t k = 0)  //
       -> PMwCASDescriptor *;
 
+  /**
+   * @param slot A thread slot owned by the current thread.
+   * @param k The index of a descriptor in the slot's ring.
+   * @return The k-th PMwCAS descriptor of the given slot.
+   * @throws std::out_of_range if the slot is out of the thread slots of this
+   * pool.
+   * @note Each slot must be used by only one thread at the same time.
+   */
+  auto GetInSlot(  //
+      size_t slot,
+      size_t k = 0)  //
+      -> PMwCASDescriptor *;
+
+  /**
+   * @brief Recover an unrecovered descriptor embedded in a given word.
+   *
+   * @param desc_word A word that has an embedded PMwCAS descriptor.
+   * @retval true if the descriptor has been recovered lazily.
+   * @retval false if the descriptor is not in pools opened lazily.
+   * @note This function is used internally when threads read intermediate
+   * states.
+   */
+  static auto RecoverEmbedded(  //
+      uint64_t desc_word)       //
+      -> bool;
+
+  /*############################################################################
+   * Public statistics
+   *##########################################################################*/
+
+  /**
+   * @return A snapshot of statistics since the last reset.
+   * @note Statistics are counted only if PMEM_ATOMIC_ENABLE_STATS is enabled.
+   * PCAS and PLoad do not know which pool manages a word, so statistics are
+   * shared by all the pools in a process.
+   */
+  static auto GetStats()  //
+      -> Stats;
+
+  /**
+   * @brief Reset statistics to zero.
+   *
+   * Threads may update statistics concurrently, so events that occur during
+   * this call may be counted in either side of the reset.
+   */
+  static void ResetStats();
+
  private:
+  /*############################################################################
+   * Internal types
+   *##########################################################################*/
+
+  struct PoolHeader;
+
+  /**
+   * @brief A pmemobj pool holding descriptors on one NUMA node.
+   *
+   */
+  struct Partition {
+    /// @brief The pmemobj_pool for holding PMwCAS descriptors (null if volatile).
+    PMEMobjpool *pop{nullptr};
+
+    /// @brief The header of this pool.
+    PoolHeader *header{nullptr};
+
+    /// @brief The head of PMwCAS descriptors.
+    std::byte *desc_pool{nullptr};
+
+    /// @brief The recovery states of descriptors (null if all are recovered).
+    std::atomic_uint8_t *recovered{nullptr};
+  };
+
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  /**
+   * @param part A partition of descriptors.
+   * @param i The index of a descriptor in the partition.
+   * @return The i-th PMwCAS descriptor.
+   */
+  [[nodiscard]] auto
+  GetDescriptor(  //
+      const Partition &part,
+      const size_t i) const  //
+      -> PMwCASDescriptor *
+  {
+    return reinterpret_cast<PMwCASDescriptor *>(part.desc_pool + desc_size_ * i);
+  }
+
+  /**
+   * @return The partition on the NUMA node where the current thread runs.
+   */
+  [[nodiscard]] auto GetLocalPartition() const  //
+      -> const Partition &;
+
+  /**
+   * @brief Open a pmemobj pool and recover its descriptors if needed.
+   *
+   * @param pmem_path The path to a pmemobj pool for PMwCAS.
+   * @param layout_name The layout name to distinguish application.
+   * @param node The NUMA node of the pool or -1 to detect it.
+   */
+  void Open(  //
+      const std::string &pmem_path,
+      const std::string &layout_name,
+      int node);
+
+  /**
+   * @brief Register the descriptors of a partition for lazy recovery.
+   *
+   * @param part A partition to be recovered lazily.
+   */
+  void PrepareLazyRecovery(  //
+      Partition &part);
+
+  /**
+   * @brief Recover the descriptors of a thread in a lazily opened partition.
+   *
+   * @param part A partition including the descriptors.
+   * @param first The index of the first descriptor of the thread.
+   */
+  void RecoverThreadDescriptors(  //
+      const Partition &part,
+      size_t first) const;
+
+  /**
+   * @brief Initialize all the descriptors and roll back/forward dirty ones.
+   *
+   * If PMEM_ATOMIC_RECOVERY_THREAD_NUM is greater than one, descriptors are
+   * split across worker threads, which are pinned to the NUMA node of the
+   * pool if it is known.
+   *
+   * @param part A partition to be recovered.
+   * @param node The NUMA node of the partition or -1 if it is unknown.
+   */
+  void Recover(  //
+      const Partition &part,
+      int node);
+
+  /**
+   * @brief Mark pools as cleanly closed if possible and close them.
+   *
+   */
+  void Close();
+
   /*############################################################################
    * Internal member variables
    *##########################################################################*/
 
-  /// @brief The pmemobj_pool for holding PMwCAS descriptors.
-  PMEMobjpool *pop_{nullptr};
+  /// @brief Pools of PMwCAS descriptors for each NUMA node.
+  std::vector<Partition> partitions_{};
+
+  /// @brief The indices of partitions for each CPU.
+  std::vector<uint32_t> cpu_to_part_{};
+
+  /// @brief The maximum number of targets in each descriptor.
+  size_t capacity_{kPMwCASCapacity};
+
+  /// @brief The size of each descriptor in bytes.
+  size_t desc_size_{PMwCASDescriptor::GetSize()};
+
+  /// @brief The number of thread slots.
+  size_t slot_num_{::dbgroup::thread::kMaxThreadNum};
+
+  /// @brief A function that returns the slot of the current thread.
+  std::function<size_t()> slot_mapper_{};
+
+  /// @brief The number of descriptors in each partition.
+  size_t desc_num_{::dbgroup::thread::kMaxThreadNum * kDescNumPerThread};
 
-  /// @brief The pool of PMwCAS descriptors.
-  PMwCASDescriptor *desc_pool_{nullptr};
+  /// @brief A flag for deferring recovery until descriptors are used.
+  bool lazy_recovery_{false};
 };
 
 }  // namespace dbgroup::pmem::atomic
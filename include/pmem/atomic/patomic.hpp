@@ -0,0 +1,324 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_PATOMIC_HPP
+#define PMEM_ATOMIC_PATOMIC_HPP
+
+// C++ standard libraries
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// local sources
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/component/common.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic
+{
+/**
+ * @brief A class to wrap a persistent word and its atomic operations.
+ *
+ * Each operation is selected at compile time according to the class of a word,
+ * whether the word can be a PMwCAS target, and PMEM_ATOMIC_USE_DIRTY_FLAG. If
+ * neither dirty flags nor PMwCAS are used, a word never has intermediate states
+ * and `load` is a plain atomic load.
+ *
+ * @tparam T A class of a wrapped word.
+ * @tparam kPMwCASTarget A flag for indicating the word may be a PMwCAS target.
+ * @note This class has the same layout as `T`, so it can be placed on
+ * persistent memory directly.
+ */
+template <class T, bool kPMwCASTarget = true>
+class PAtomic
+{
+  static_assert(component::IsAtomic<T>());
+
+ public:
+  /*############################################################################
+   * Public constructors and assignment operators
+   *##########################################################################*/
+
+  /**
+   * @brief Construct a new PAtomic object.
+   *
+   * @param init An initial value.
+   * @note This constructor does not persist the initial value.
+   */
+  constexpr explicit PAtomic(  //
+      const T init = T{})
+      : word_{init}
+  {
+  }
+
+  PAtomic(const PAtomic &) = delete;
+  PAtomic(PAtomic &&) = delete;
+
+  auto operator=(const PAtomic &) -> PAtomic & = delete;
+  auto operator=(PAtomic &&) -> PAtomic & = delete;
+
+  /*############################################################################
+   * Public destructors
+   *##########################################################################*/
+
+  /**
+   * @brief Destroy the PAtomic object.
+   *
+   */
+  ~PAtomic() = default;
+
+  /*############################################################################
+   * Public getters/setters
+   *##########################################################################*/
+
+  /**
+   * @return The address of the wrapped word for PMwCAS descriptors.
+   */
+  [[nodiscard]] auto
+  address()  //
+      -> T *
+  {
+    return &word_;
+  }
+
+  /*############################################################################
+   * Public utilities
+   *##########################################################################*/
+
+  /**
+   * @param order A memory barrier for this operation.
+   * @return The current value of the word.
+   */
+  [[nodiscard]] auto
+  load(  //
+      const std::memory_order order = std::memory_order_seq_cst) const  //
+      -> T
+  {
+    if constexpr (kHasIntermediateState) {
+      return PLoad(const_cast<T *>(&word_), order);
+    } else {
+      return component::FromUInt64<T>(GetWordAddr()->load(order));
+    }
+  }
+
+  /**
+   * @param order A memory barrier for this operation.
+   * @return The current logical value of the word without writing anything.
+   * @note The returned value may not be durable yet (see `PLoadReadOnly`).
+   */
+  [[nodiscard]] auto
+  load_read_only(  //
+      const std::memory_order order = std::memory_order_seq_cst) const  //
+      -> T
+  {
+    if constexpr (kHasIntermediateState) {
+      return PLoadReadOnly(&word_, order);
+    } else {
+      return component::FromUInt64<T>(GetWordAddr()->load(order));
+    }
+  }
+
+  /**
+   * @param[in,out] expected An expected value.
+   * @param[in] desired A desired value.
+   * @param[in] order A memory barrier for this operation.
+   * @retval true if this operation succeeds.
+   * @retval false otherwise.
+   */
+  auto
+  compare_exchange(  //
+      T &expected,
+      const T desired,
+      const std::memory_order order = std::memory_order_seq_cst)  //
+      -> bool
+  {
+    return PCAS(&word_, expected, desired, order);
+  }
+
+  /**
+   * @param[in,out] expected An expected value.
+   * @param[in] desired A desired value.
+   * @param[in] success A memory barrier in case CAS succeeds.
+   * @param[in] failure A memory barrier in case CAS fails.
+   * @retval true if this operation succeeds.
+   * @retval false otherwise.
+   */
+  auto
+  compare_exchange(  //
+      T &expected,
+      const T desired,
+      const std::memory_order success,
+      const std::memory_order failure)  //
+      -> bool
+  {
+    return PCAS(&word_, expected, desired, success, failure);
+  }
+
+  /**
+   * @param desired A value to be stored.
+   * @param order A memory barrier for this operation.
+   */
+  void
+  store(  //
+      const T desired,
+      const std::memory_order order = std::memory_order_seq_cst)
+  {
+    if constexpr (kHasIntermediateState) {
+      exchange(desired, order);
+    } else {
+      auto *word_addr = GetWordAddr();
+      const auto word = component::ToUInt64(desired);
+      word_addr->store(word, order);
+      component::PersistWord(word_addr, word, order);
+    }
+  }
+
+  /**
+   * @param desired A value to be stored.
+   * @param order A memory barrier for this operation.
+   * @return The previous value of the word.
+   */
+  auto
+  exchange(  //
+      const T desired,
+      const std::memory_order order = std::memory_order_seq_cst)  //
+      -> T
+  {
+    if constexpr (kNeedCASLoop) {
+      return UpdateByCAS([desired](const T) { return desired; }, order);
+    } else {
+      return PExchange(&word_, desired, order);
+    }
+  }
+
+  /**
+   * @param val A value to be added.
+   * @param order A memory barrier for this operation.
+   * @return The previous value of the word.
+   */
+  auto
+  fetch_add(  //
+      const T val,
+      const std::memory_order order = std::memory_order_seq_cst)  //
+      -> T
+  {
+    static_assert(std::is_same_v<T, uint64_t>);
+
+    if constexpr (kNeedCASLoop) {
+      return UpdateByCAS([val](const T w) { return w + val; }, order);
+    } else {
+      return PFetchAdd(&word_, val, order);
+    }
+  }
+
+  /**
+   * @param val A bit pattern to be set.
+   * @param order A memory barrier for this operation.
+   * @return The previous value of the word.
+   */
+  auto
+  fetch_or(  //
+      const T val,
+      const std::memory_order order = std::memory_order_seq_cst)  //
+      -> T
+  {
+    static_assert(std::is_same_v<T, uint64_t>);
+
+    if constexpr (kNeedCASLoop) {
+      return UpdateByCAS([val](const T w) { return w | val; }, order);
+    } else {
+      return PFetchOr(&word_, val, order);
+    }
+  }
+
+  /**
+   * @param val A bit mask to be applied.
+   * @param order A memory barrier for this operation.
+   * @return The previous value of the word.
+   */
+  auto
+  fetch_and(  //
+      const T val,
+      const std::memory_order order = std::memory_order_seq_cst)  //
+      -> T
+  {
+    static_assert(std::is_same_v<T, uint64_t>);
+
+    if constexpr (kNeedCASLoop) {
+      return UpdateByCAS([val](const T w) { return w & val; }, order);
+    } else {
+      return PFetchAnd(&word_, val, order);
+    }
+  }
+
+ private:
+  /*############################################################################
+   * Internal constants
+   *##########################################################################*/
+
+  /// @brief A flag for indicating the word may have dirty flags or descriptors.
+  static constexpr bool kHasIntermediateState = kUseDirtyFlag || kPMwCASTarget;
+
+  /// @brief Single RMW instructions may overwrite embedded PMwCAS descriptors.
+  static constexpr bool kNeedCASLoop = !kUseDirtyFlag && kPMwCASTarget;
+
+  /*############################################################################
+   * Internal utilities
+   *##########################################################################*/
+
+  /**
+   * @return The address of the wrapped word as an atomic integer.
+   */
+  [[nodiscard]] auto
+  GetWordAddr() const  //
+      -> std::atomic_uint64_t *
+  {
+    return reinterpret_cast<std::atomic_uint64_t *>(const_cast<T *>(&word_));
+  }
+
+  /**
+   * @brief Update the word by using a given function and PCAS.
+   *
+   * @tparam Func A class of update functions.
+   * @param update A function to compute a new value from the current one.
+   * @param order A memory barrier for this operation.
+   * @return The previous value of the word.
+   */
+  template <class Func>
+  auto
+  UpdateByCAS(  //
+      Func &&update,
+      const std::memory_order order)  //
+      -> T
+  {
+    auto expected = PLoad(&word_, std::memory_order_relaxed);
+    while (!PCAS(&word_, expected, update(expected), order)) {
+      // continue until PCAS succeeds
+    }
+    return expected;
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief The wrapped persistent word.
+  T word_{};
+};
+
+}  // namespace dbgroup::pmem::atomic
+
+#endif  // PMEM_ATOMIC_PATOMIC_HPP
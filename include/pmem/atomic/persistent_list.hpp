@@ -0,0 +1,281 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_PERSISTENT_LIST_HPP
+#define PMEM_ATOMIC_PERSISTENT_LIST_HPP
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+
+// local sources
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic
+{
+/**
+ * @brief A persistent lock-free sorted linked list of key-value pairs.
+ *
+ * This list is built on a caller-provided region of persistent memory, and
+ * every update is an all-or-nothing PMwCAS operation. That is, this list
+ * does not need any recovery except for the recovery of its descriptor pool.
+ *
+ * - An insertion allocates and links a node with one PMwCAS operation.
+ * - A deletion unlinks a node and marks it as deleted with one PMwCAS
+ *   operation, so no other insertion can be linked after the deleted node.
+ * - An update only swaps the value of a node by a single-target PMwCAS
+ *   operation. Since a deletion embeds its descriptor into the value, PCAS
+ *   cannot be used for the value.
+ *
+ * @note Nodes are allocated by a persistent cursor and never reused, so the
+ * capacity bounds the number of insertions over the lifetime of the region.
+ * This avoids ABA problems and use-after-free of concurrently read nodes.
+ */
+class PersistentList
+{
+ public:
+  /*############################################################################
+   * Public constants
+   *##########################################################################*/
+
+  /// @brief The maximum value that can be stored in this list.
+  /// @note Keys and values must not have intermediate flags of PCAS/PMwCAS.
+  static constexpr uint64_t kMaxValue = ~kIsIntermediate - 1;
+
+  /*############################################################################
+   * Public constructors and assignment operators
+   *##########################################################################*/
+
+  /**
+   * @brief Construct a new PersistentList object over a given region.
+   *
+   * @param region A region with the size of `GetRegionSize(capacity)`.
+   * @param capacity The maximum number of nodes in the region.
+   * @param pool A descriptor pool for PMwCAS operations.
+   * @throws std::invalid_argument if the descriptors of the pool cannot hold
+   * the targets of an insertion.
+   * @note The region must be zero-filled when it is used for the first time
+   * (e.g., the root object of a new pmemobj pool), and must be reopened with
+   * the same capacity. If the pool is persistent, the region must be in one
+   * pmemobj pool.
+   */
+  PersistentList(  //
+      void *region,
+      size_t capacity,
+      DescriptorPool &pool);
+
+  PersistentList(const PersistentList &) = delete;
+  PersistentList(PersistentList &&) = delete;
+
+  auto operator=(const PersistentList &obj) -> PersistentList & = delete;
+  auto operator=(PersistentList &&) -> PersistentList & = delete;
+
+  /*############################################################################
+   * Public destructors
+   *##########################################################################*/
+
+  /**
+   * @brief Destroy the PersistentList object.
+   *
+   * @note The contents of this list remain in the given region.
+   */
+  ~PersistentList() = default;
+
+  /*############################################################################
+   * Public getters/setters
+   *##########################################################################*/
+
+  /**
+   * @param capacity The maximum number of nodes in a list.
+   * @return The size of a region for the list in bytes.
+   */
+  [[nodiscard]] static constexpr auto
+  GetRegionSize(  //
+      const size_t capacity) noexcept  //
+      -> size_t
+  {
+    return kWordSize + sizeof(Node) * (capacity + 1);
+  }
+
+  /**
+   * @return The maximum number of nodes in this list.
+   */
+  [[nodiscard]] constexpr auto
+  Capacity() const  //
+      -> size_t
+  {
+    return capacity_;
+  }
+
+  /**
+   * @return The number of allocated nodes including deleted ones.
+   */
+  [[nodiscard]] auto AllocatedNum() const  //
+      -> size_t;
+
+  /*############################################################################
+   * Public utilities
+   *##########################################################################*/
+
+  /**
+   * @brief Read the value of a given key.
+   *
+   * @param[in] key A target key.
+   * @param[out] value The value of the key if it exists.
+   * @retval true if the key exists.
+   * @retval false otherwise.
+   */
+  auto Read(  //
+      uint64_t key,
+      uint64_t &value) const  //
+      -> bool;
+
+  /**
+   * @brief Insert a new key-value pair.
+   *
+   * @param key A target key (at most `kMaxValue`).
+   * @param value A value to be inserted (at most `kMaxValue`).
+   * @retval true if the pair is inserted.
+   * @retval false if the key exists or all the nodes have been allocated.
+   */
+  auto Insert(  //
+      uint64_t key,
+      uint64_t value)  //
+      -> bool;
+
+  /**
+   * @brief Update the value of an existing key.
+   *
+   * @param key A target key.
+   * @param value A new value (at most `kMaxValue`).
+   * @retval true if the value is updated.
+   * @retval false if the key does not exist.
+   */
+  auto Update(  //
+      uint64_t key,
+      uint64_t value)  //
+      -> bool;
+
+  /**
+   * @brief Delete a given key.
+   *
+   * @param key A target key.
+   * @retval true if the key is deleted.
+   * @retval false if the key does not exist.
+   */
+  auto Delete(  //
+      uint64_t key)  //
+      -> bool;
+
+ private:
+  /*############################################################################
+   * Internal classes
+   *##########################################################################*/
+
+  /**
+   * @brief A node of a list.
+   *
+   */
+  struct Node {
+    /// @brief The key of this node.
+    uint64_t key;
+
+    /// @brief The value of this node or a tombstone if deleted.
+    uint64_t value;
+
+    /// @brief The index of the next node with a deleted flag.
+    uint64_t next;
+  };
+
+  /**
+   * @brief A position in a list found by a search.
+   *
+   */
+  struct Position {
+    /// @brief The last node whose key is less than a search key.
+    Node *pred;
+
+    /// @brief The next word of the predecessor.
+    uint64_t pred_next;
+
+    /// @brief The first node whose key is not less than a search key.
+    Node *cur;
+
+    /// @brief The key of the current node.
+    uint64_t key;
+  };
+
+  /*############################################################################
+   * Internal constants
+   *##########################################################################*/
+
+  /// @brief A flag in next words for indicating their nodes are deleted.
+  static constexpr uint64_t kDeletedFlag = 1UL;
+
+  /// @brief A value for indicating deleted nodes.
+  static constexpr uint64_t kTombstone = kMaxValue + 1;
+
+  /// @brief The number of targets of an insertion.
+  static constexpr size_t kInsertTargetNum = 5;
+
+  /*############################################################################
+   * Internal utilities
+   *##########################################################################*/
+
+  /**
+   * @param next A next word.
+   * @return The node of the word or nullptr if the word is the end.
+   */
+  [[nodiscard]] auto
+  GetNode(  //
+      const uint64_t next) const  //
+      -> Node *
+  {
+    const auto idx = next >> 1UL;
+    return idx == 0 ? nullptr : &(nodes_[idx]);
+  }
+
+  /**
+   * @brief Search the position of a given key.
+   *
+   * @param key A search key.
+   * @return The position of the key.
+   */
+  [[nodiscard]] auto Search(  //
+      uint64_t key) const     //
+      -> Position;
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief The number of allocated nodes.
+  uint64_t *cursor_{nullptr};
+
+  /// @brief Nodes in a region, where the first one is the head of this list.
+  Node *nodes_{nullptr};
+
+  /// @brief The maximum number of nodes in this list.
+  size_t capacity_{0};
+
+  /// @brief A descriptor pool for PMwCAS operations.
+  DescriptorPool *pool_{nullptr};
+};
+
+}  // namespace dbgroup::pmem::atomic
+
+#endif  // PMEM_ATOMIC_PERSISTENT_LIST_HPP
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PMEM_ATOMIC_PERSISTENT_RING_BUFFER_HPP
+#define PMEM_ATOMIC_PERSISTENT_RING_BUFFER_HPP
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+
+// local sources
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic
+{
+/**
+ * @brief A persistent lock-free bounded FIFO queue of words.
+ *
+ * This ring buffer is built on a caller-provided region of persistent memory.
+ * A push fills the slot at the tail and advances the tail with one PMwCAS
+ * operation, and a pop clears the slot at the head and advances the head in
+ * the same way. Since both updates are all-or-nothing, a crash never loses or
+ * duplicates values, and this buffer does not need any recovery except for
+ * the recovery of its descriptor pool.
+ *
+ * @note Empty slots are represented by zero, so values are stored with an
+ * offset of one.
+ */
+class PersistentRingBuffer
+{
+ public:
+  /*############################################################################
+   * Public constants
+   *##########################################################################*/
+
+  /// @brief The maximum value that can be stored in this buffer.
+  /// @note Values must not have intermediate flags of PCAS/PMwCAS.
+  static constexpr uint64_t kMaxValue = ~kIsIntermediate - 1;
+
+  /*############################################################################
+   * Public constructors and assignment operators
+   *##########################################################################*/
+
+  /**
+   * @brief Construct a new PersistentRingBuffer object over a given region.
+   *
+   * @param region A region with the size of `GetRegionSize(capacity)`.
+   * @param capacity The maximum number of values in the region.
+   * @param pool A descriptor pool for PMwCAS operations.
+   * @throws std::invalid_argument if the capacity is zero.
+   * @note The region must be zero-filled when it is used for the first time
+   * (e.g., the root object of a new pmemobj pool), and must be reopened with
+   * the same capacity. If the pool is persistent, the region must be in one
+   * pmemobj pool.
+   */
+  PersistentRingBuffer(  //
+      void *region,
+      size_t capacity,
+      DescriptorPool &pool);
+
+  PersistentRingBuffer(const PersistentRingBuffer &) = delete;
+  PersistentRingBuffer(PersistentRingBuffer &&) = delete;
+
+  auto operator=(const PersistentRingBuffer &obj) -> PersistentRingBuffer & = delete;
+  auto operator=(PersistentRingBuffer &&) -> PersistentRingBuffer & = delete;
+
+  /*############################################################################
+   * Public destructors
+   *##########################################################################*/
+
+  /**
+   * @brief Destroy the PersistentRingBuffer object.
+   *
+   * @note The contents of this buffer remain in the given region.
+   */
+  ~PersistentRingBuffer() = default;
+
+  /*############################################################################
+   * Public getters/setters
+   *##########################################################################*/
+
+  /**
+   * @param capacity The maximum number of values in a buffer.
+   * @return The size of a region for the buffer in bytes.
+   * @note The head and tail are placed on different cache lines.
+   */
+  [[nodiscard]] static constexpr auto
+  GetRegionSize(  //
+      const size_t capacity) noexcept  //
+      -> size_t
+  {
+    return 2 * kCacheLineSize + kWordSize * capacity;
+  }
+
+  /**
+   * @return The maximum number of values in this buffer.
+   */
+  [[nodiscard]] constexpr auto
+  Capacity() const  //
+      -> size_t
+  {
+    return capacity_;
+  }
+
+  /**
+   * @return The number of values in this buffer.
+   * @note The result may be stale if other threads push or pop values.
+   */
+  [[nodiscard]] auto Size() const  //
+      -> size_t;
+
+  /*############################################################################
+   * Public utilities
+   *##########################################################################*/
+
+  /**
+   * @brief Push a value to the tail of this buffer.
+   *
+   * @param value A value to be pushed (at most `kMaxValue`).
+   * @retval true if the value is pushed.
+   * @retval false if this buffer is full.
+   */
+  auto Push(  //
+      uint64_t value)  //
+      -> bool;
+
+  /**
+   * @brief Pop a value from the head of this buffer.
+   *
+   * @param[out] value The popped value.
+   * @retval true if a value is popped.
+   * @retval false if this buffer is empty.
+   */
+  auto Pop(  //
+      uint64_t &value)  //
+      -> bool;
+
+ private:
+  /*############################################################################
+   * Internal utilities
+   *##########################################################################*/
+
+  /**
+   * @param pos A logical position in this buffer.
+   * @return The address of the slot for the position.
+   */
+  [[nodiscard]] auto
+  GetSlot(  //
+      const uint64_t pos) const  //
+      -> uint64_t *
+  {
+    return &(slots_[pos % capacity_]);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief The logical position of the first value.
+  uint64_t *head_{nullptr};
+
+  /// @brief The logical position of the next push.
+  uint64_t *tail_{nullptr};
+
+  /// @brief The slots of values.
+  uint64_t *slots_{nullptr};
+
+  /// @brief The maximum number of values in this buffer.
+  size_t capacity_{0};
+
+  /// @brief A descriptor pool for PMwCAS operations.
+  DescriptorPool *pool_{nullptr};
+};
+
+}  // namespace dbgroup::pmem::atomic
+
+#endif  // PMEM_ATOMIC_PERSISTENT_RING_BUFFER_HPP
@@ -18,18 +18,83 @@
 #define PMEM_ATOMIC_PMWCAS_DESCRIPTOR_HPP
 
 // C++ standard libraries
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <utility>
 
 // local sources
+#include "pmem/atomic/component/backoff.hpp"
 #include "pmem/atomic/component/common.hpp"
 #include "pmem/atomic/component/pmwcas_target.hpp"
 #include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic
 {
+/**
+ * @brief A target word of a fixed-arity PMwCAS operation.
+ *
+ * @tparam T A class of a target.
+ */
+template <class T>
+struct PMwCASEntry {
+  static_assert(component::IsAtomic<T>());
+
+  /// @brief A target memory address.
+  T *addr{nullptr};
+
+  /// @brief An expected value of a target field.
+  T old_val{};
+
+  /// @brief An inserting value into a target field.
+  T new_val{};
+
+  /// @brief A flag for controling std::memory_order.
+  std::memory_order fence{std::memory_order_seq_cst};
+};
+
+template <class T>
+PMwCASEntry(T *, T, T) -> PMwCASEntry<T>;
+
+template <class T>
+PMwCASEntry(T *, T, T, std::memory_order) -> PMwCASEntry<T>;
+
+/**
+ * @brief A target that caused a PMwCAS operation to fail.
+ *
+ */
+struct PMwCASConflict {
+  /// @brief The address of the conflicting target.
+  /// @note This is nullptr if helping threads decided the failure.
+  const void *addr{nullptr};
+
+  /// @brief The position of the conflicting target in a descriptor chain.
+  /// @note Positions follow the order of `Add` unless duplicate targets are
+  /// merged or PMEM_ATOMIC_SORT_PMWCAS_TARGETS is enabled.
+  size_t index{0};
+
+  /// @brief The word read from the conflicting target just after the failure.
+  /// @note This word may have intermediate flags (i.e., an embedded
+  /// descriptor or a dirty flag), so use `PLoad` to get a logical value.
+  uint64_t observed{0};
+
+  /**
+   * @retval true if the target was locked by another operation in progress.
+   * @retval false if the target had a value different from the expected one.
+   */
+  [[nodiscard]] constexpr auto
+  IsInProgress() const  //
+      -> bool
+  {
+    return addr == nullptr || (observed & kIsIntermediate) != 0;
+  }
+};
+
 /**
  * @brief A class to manage a PMwCAS (multi-words compare-and-swap) operation.
  *
@@ -73,11 +138,66 @@ class alignas(kPMEMLineSize) PMwCASDescriptor
   /**
    * @return The number of targets added to PMwCAS.
    */
-  [[nodiscard]] constexpr auto
+  [[nodiscard]] auto
   Size() const  //
       -> size_t
   {
-    return target_count_;
+    return (state_.load(std::memory_order_relaxed) & kCountMask) >> kCountShift;
+  }
+
+  /**
+   * @return The maximum number of targets in this descriptor.
+   */
+  [[nodiscard]] constexpr auto
+  Capacity() const  //
+      -> size_t
+  {
+    return capacity_;
+  }
+
+  /**
+   * @retval true if this descriptor and its targets are on persistent memory.
+   * @retval false if they are on volatile memory and never flushed.
+   */
+  [[nodiscard]] constexpr auto
+  IsPersistent() const  //
+      -> bool
+  {
+    return persistent_;
+  }
+
+  /**
+   * @retval true if this descriptor has a started PMwCAS operation.
+   * @retval false otherwise.
+   */
+  [[nodiscard]] auto
+  IsPending() const  //
+      -> bool
+  {
+    return (state_.load(std::memory_order_relaxed) & kStatusMask) != DescStatus::kCompleted;
+  }
+
+  /**
+   * @return The word embedded into targets by the started PMwCAS operation.
+   * @note The address in the word is that of the process that started the
+   * operation, so it may differ from this descriptor after restarts.
+   */
+  [[nodiscard]] auto GetDescWord() const  //
+      -> uint64_t;
+
+  /**
+   * @param capacity The maximum number of targets in a descriptor.
+   * @return The size of a descriptor with the given capacity in bytes.
+   * @note The returned size is aligned to Intel Optane's internal line size.
+   */
+  [[nodiscard]] static constexpr auto
+  GetSize(  //
+      const size_t capacity = kPMwCASCapacity) noexcept  //
+      -> size_t
+  {
+    constexpr size_t kMask = kPMEMLineSize - 1;
+    const auto size = offsetof(PMwCASDescriptor, targets_) + sizeof(PMwCASTarget) * capacity;
+    return (size + kMask) & ~kMask;
   }
 
   /*############################################################################
@@ -87,11 +207,24 @@ class alignas(kPMEMLineSize) PMwCASDescriptor
   /**
    * @brief Add a new PMwCAS target to this descriptor.
    *
+   * If the same address has been already added, the given update is chained to
+   * the registered one. That is, the target keeps the first expected value and
+   * is overwritten by the last desired value and fence. If an expected value
+   * differs from the desired value of the previous update, the updates can
+   * never succeed together, so the PMwCAS operation fails.
+   *
    * @tparam T A class of a target.
    * @param addr A target memory address.
    * @param old_val An expected value of a target field.
    * @param new_val An inserting value into a target field.
    * @param fence A flag for controling std::memory_order.
+   * @note If PMEM_ATOMIC_SORT_PMWCAS_TARGETS is enabled, targets are kept in
+   * ascending address order to give a global order for embedding descriptors.
+   * @throws std::invalid_argument if this descriptor is persistent and the
+   * target is not in the pmemobj pool of the already added ones. A persistent
+   * descriptor records the pool only once for recovery.
+   * @note If overflow descriptors are linked by `Extend`, a full descriptor
+   * passes the subsequent targets to the next one.
    */
   template <class T>
   void
@@ -101,40 +234,553 @@ class alignas(kPMEMLineSize) PMwCASDescriptor
       const T new_val,
       const std::memory_order fence = std::memory_order_seq_cst)
   {
-    assert(target_count_ < kPMwCASCapacity);
-    targets_[target_count_++] = PMwCASTarget{addr, old_val, new_val, fence};
+    if (IsPending()) FinishPMwCAS();
+
+    // search a duplicate target or an insertion position
+    auto *desc = this;
+    size_t pos = 0;
+    for (auto *cur = this; cur != nullptr; cur = cur->GetNext()) {
+      desc = cur;
+      const auto count = cur->Size();
+      for (pos = 0; pos < count; ++pos) {
+        const auto *target_addr = cur->targets_[pos].GetAddr();
+        if (target_addr == addr) {
+          cur->targets_[pos].Chain(old_val, new_val, fence);
+          return;
+        }
+        if constexpr (kSortPMwCASTargets) {
+          if (std::less<const void *>{}(addr, target_addr)) break;
+        }
+      }
+      if (pos < count || count < cur->capacity_) break;
+    }
+
+    desc->Insert(pos, PMwCASTarget{addr, old_val, new_val, fence});
+  }
+
+  /**
+   * @brief Link an overflow descriptor to perform a PMwCAS operation with more
+   * targets than the capacity of this descriptor.
+   *
+   * The linked descriptors only hold additional targets, and this descriptor
+   * decides the status of the whole operation with its state word. `Add` and
+   * `PMwCAS` must be called for this descriptor, and the chain is unlinked
+   * when the operation finishes.
+   *
+   * @param desc An empty descriptor to be appended to the chain.
+   * @note The linked descriptors must be in the same descriptor pool (e.g.,
+   * `DescriptorPool::Get(1)` of the same thread) because recovery follows
+   * the chain by offsets from this descriptor.
+   */
+  void Extend(  //
+      PMwCASDescriptor *desc);
+
+  /**
+   * @brief Perform a PMwCAS operation with a fixed number of targets.
+   *
+   * This function writes all the given targets into this descriptor at once
+   * instead of searching duplicates for each target as `Add` does, and the
+   * subsequent protocol is unrolled for the number of targets. Any targets
+   * added by `Add` beforehand are discarded.
+   *
+   * @tparam Ts Classes of targets.
+   * @param entries Target words (e.g., `PMwCASEntry{&word, old_val, new_val}`).
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   * @throws std::invalid_argument if this descriptor is persistent and the
+   * targets are in different pmemobj pools.
+   * @note The target addresses must be distinct.
+   * @note This function cannot be used with overflow descriptors.
+   */
+  template <class... Ts>
+  auto
+  PMwCAS(  //
+      const PMwCASEntry<Ts> &...entries)  //
+      -> bool
+  {
+    constexpr size_t kNum = sizeof...(Ts);
+    static_assert(kNum > 0 && kNum <= kPMwCASCapacity);
+    assert(kNum <= capacity_);
+    assert(next_addr_ == 0);
+
+    if (IsPending()) FinishPMwCAS();
+
+    SetSize(0);  // discard the targets even if an entry is rejected
+    size_t i = 0;
+    (SetTarget(i++, entries), ...);
+    if constexpr (kSortPMwCASTargets && kNum > 1) {
+      // insertion sort is enough for a few targets
+      for (size_t j = 1; j < kNum; ++j) {
+        const auto target = targets_[j];
+        auto k = j;
+        for (; k > 0; --k) {
+          if (!std::less<const void *>{}(target.GetAddr(), targets_[k - 1].GetAddr())) break;
+          targets_[k] = targets_[k - 1];
+        }
+        targets_[k] = target;
+      }
+    }
+    SetSize(kNum);
+
+    return PMwCAS();
   }
 
   /**
    * @brief Perform a PMwCAS operation by using registered targets.
    *
+   * Before persisting this descriptor, all the targets are read with relaxed
+   * loads, and this operation fails immediately if any of them has a value
+   * different from its expected one. This early-out only inspects each word
+   * independently, so it is not linearizable as a multi-word snapshot; the
+   * failure just means that the word had another value at the time of the
+   * read. A PMwCAS operation that passes this check is performed with the
+   * usual protocol and may still fail.
+   *
    * @retval true if a PMwCAS operation succeeds.
    * @retval false if a PMwCAS operation fails.
    */
   auto PMwCAS()  //
       -> bool;
 
+  /**
+   * @brief Perform a PMwCAS operation and report the target causing a failure.
+   *
+   * @param[out] conflict The conflicting target if the operation fails.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   * @note `conflict` is not modified if the operation succeeds.
+   */
+  auto PMwCAS(  //
+      PMwCASConflict &conflict)  //
+      -> bool;
+
+  /**
+   * @brief Perform PMwCAS operations until one of them succeeds.
+   *
+   * Before each attempt, `prepare` adds targets to this descriptor. It is
+   * given the conflict of the previous attempt (nullptr at the first one), so
+   * the caller can reread only the conflicting word instead of all the
+   * targets. If the previous attempt conflicted with another operation in
+   * progress, this function waits with the current back-off policy before
+   * calling `prepare` again.
+   *
+   * @tparam Func A class of functions with the signature
+   * `bool(PMwCASDescriptor &, const PMwCASConflict *)`.
+   * @param prepare A function to add targets or return false to give up.
+   * @param max_retry The maximum number of retries.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if `prepare` gives up or all the attempts fail.
+   * @note `prepare` must return false before adding any target.
+   */
+  template <class Func>
+  auto
+  PMwCASWithRetry(  //
+      Func &&prepare,
+      const size_t max_retry = std::numeric_limits<size_t>::max())  //
+      -> bool
+  {
+    PMwCASConflict conflict{};
+    const PMwCASConflict *prev = nullptr;
+    for (size_t i = 0;; ++i) {
+      if (!prepare(*this, prev)) return false;
+      if (PMwCAS(conflict)) return true;
+      if (i >= max_retry) return false;
+
+      // wait for the conflicting operation to release the target
+      if (conflict.addr != nullptr && conflict.IsInProgress()) {
+        const auto *word_addr = static_cast<const std::atomic_uint64_t *>(conflict.addr);
+        component::Backoff(word_addr, conflict.observed);
+      }
+      prev = &conflict;
+    }
+  }
+
+  /**
+   * @brief Perform a PMwCAS operation without waiting for its final flushes.
+   *
+   * The result of a PMwCAS operation is durable when this function returns,
+   * and other threads can read its updated values. However, this descriptor
+   * keeps its log until FinishPMwCAS is called, so a thread can use another
+   * descriptor to hide the latency of draining flushed targets.
+   *
+   * @param[out] conflict An optional output of the target causing a failure.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   * @note Adding a new target or starting a new PMwCAS operation implicitly
+   * finishes the previous one.
+   */
+  auto StartPMwCAS(  //
+      PMwCASConflict *conflict = nullptr)  //
+      -> bool;
+
+  /**
+   * @brief Wait for the final flushes of a started PMwCAS operation and reset
+   * this descriptor.
+   *
+   * This function does nothing if there is no started PMwCAS operation.
+   */
+  void FinishPMwCAS();
+
   /**
    * @brief Initialize this descriptor and perform recovery if needed.
    *
+   * @param capacity The maximum number of targets in this descriptor.
+   * @param persistent A flag for indicating this descriptor and its targets are
+   * on persistent memory. If false, PMwCAS operations skip all the flushes and
+   * a zero-filled descriptor is assumed.
+   * @throws std::invalid_argument if this descriptor is not aligned to
+   * `kPMEMLineSize`.
+   * @note The memory region of this descriptor must have at least the size
+   * given by `GetSize(capacity)`.
+   */
+  void Initialize(  //
+      size_t capacity = kPMwCASCapacity,
+      bool persistent = true);
+
+  /**
+   * @brief Help a PMwCAS operation embedded in a given word to complete.
+   *
+   * If the PMwCAS operation is undecided, this function embeds its descriptor
+   * into the remaining targets on behalf of the owner and rolls the operation
+   * forward. The operation is rolled back only if a target has a value
+   * different from the expected one. If another operation in progress blocks
+   * a target, this function leaves the operation undecided for its owner.
+   *
+   * While helping, the owner cannot finish the operation, so the descriptor is
+   * never reused under the helping thread.
+   *
+   * @param desc_word A word that has an embedded PMwCAS descriptor.
+   * @retval true if the operation has been decided or completed.
+   * @retval false if another operation blocks the remaining targets.
+   * @note This function is used internally if PMEM_ATOMIC_HELP_PMWCAS is
+   * enabled.
+   */
+  static auto HelpPMwCAS(  //
+      uint64_t desc_word)  //
+      -> bool;
+
+  /**
+   * @brief Read the logical value of a target word without writing anything.
+   *
+   * If the PMwCAS operation embedded in a given word has succeeded, the
+   * desired value of the target is returned. Otherwise, the expected value is
+   * returned since the operation has not been linearized yet.
+   *
+   * @param[in] desc_word A word that has an embedded PMwCAS descriptor.
+   * @param[in] addr The address of the target word.
+   * @param[out] val The logical value of the target word.
+   * @retval true if the logical value is read.
+   * @retval false if the PMwCAS operation has been completed.
    */
-  void Initialize();
+  static auto ReadTarget(  //
+      uint64_t desc_word,
+      const void *addr,
+      uint64_t &val)  //
+      -> bool;
 
  private:
   /*############################################################################
-   * Internal member variables
+   * Internal constants
+   *##########################################################################*/
+
+  /// @brief A mask for extracting progress states of PMwCAS operations.
+  static constexpr uint64_t kStatusMask = 0b11UL;
+
+  /// @brief The position of the number of targets in a state word.
+  static constexpr uint64_t kCountShift = 2;
+
+  /// @brief A mask for extracting the number of targets from a state word.
+  static constexpr uint64_t kCountMask = 0xFFFFUL << kCountShift;
+
+  /// @brief A flag for indicating an overflow descriptor of a running chain.
+  static constexpr uint64_t kChainFlag = 1UL << 18UL;
+
+  /// @brief A flag for indicating the owner is finishing a PMwCAS operation.
+  /// @note Threads cannot start helping the operation after this flag is set.
+  static constexpr uint64_t kFinishFlag = 1UL << 19UL;
+
+  /// @brief The unit for counting threads helping a PMwCAS operation.
+  static constexpr uint64_t kHelperUnit = 1UL << 20UL;
+
+  /// @brief A mask for extracting the number of helping threads.
+  static constexpr uint64_t kHelperMask = 0xFFFFFUL << 20UL;
+
+  /// @brief The position of sequence numbers in a state word.
+  static constexpr uint64_t kSeqShift = 40;
+
+  /// @brief A mask for extracting sequence numbers from a state word.
+  /// @note Descriptor words hold the lower eight bits in the alignment bits of
+  /// descriptor addresses and the others above the addresses.
+  static constexpr uint64_t kSeqMask = 0x3FFFFFUL << kSeqShift;
+
+  /// @brief The unit for incrementing sequence numbers.
+  static constexpr uint64_t kSeqUnit = 1UL << kSeqShift;
+
+  /*############################################################################
+   * Internal utilities
    *##########################################################################*/
 
-  /// @brief The current state of a PMwCAS operation.
-  DescStatus status_{DescStatus::kCompleted};
+  /**
+   * @brief Decide the status of a running PMwCAS operation.
+   *
+   * @param status A desired status.
+   * @return The decided status, which may be set by other threads.
+   * @note Only the owner or helping threads can call this function.
+   */
+  auto Decide(  //
+      DescStatus status)  //
+      -> DescStatus;
+
+  /**
+   * @param state A state word.
+   * @return The sequence number in a descriptor word.
+   */
+  static auto ToWordSeq(  //
+      uint64_t state)     //
+      -> uint64_t;
+
+  /**
+   * @param desc_word A descriptor word.
+   * @return The sequence number in a state word.
+   */
+  static auto ToStateSeq(  //
+      uint64_t desc_word)  //
+      -> uint64_t;
+
+  /**
+   * @return The next descriptor in a chain or nullptr if there is none.
+   */
+  [[nodiscard]] auto
+  GetNext() const  //
+      -> PMwCASDescriptor *
+  {
+    return reinterpret_cast<PMwCASDescriptor *>(next_addr_);
+  }
 
-  /// @brief The number of targets added to PMwCAS.
-  size_t target_count_{0};
+  /**
+   * @brief Insert a target into this descriptor.
+   *
+   * If this descriptor is full, its last target is moved to the head of the
+   * next descriptor in a chain.
+   *
+   * @param pos The position of the target.
+   * @param target A target to be inserted.
+   * @throws std::invalid_argument if the target is not in the pmemobj pool of
+   * the already added targets.
+   */
+  void
+  Insert(  //
+      size_t pos,
+      PMwCASTarget target)
+  {
+    if (persistent_ && Size() > 0) {
+      CheckTargetPool(target.GetAddr());
+    }
+
+    for (auto *desc = this;; desc = desc->GetNext(), pos = 0) {
+      assert(desc != nullptr);
+
+      const auto count = desc->Size();
+      if (desc->persistent_ && count == 0) {
+        desc->SetTargetPool(target.GetAddr());
+      }
+      if (pos == count && count == desc->capacity_) continue;
+
+      auto last = desc->targets_[count == desc->capacity_ ? count - 1 : count];
+      for (auto i = std::min<size_t>(count, desc->capacity_ - 1); i > pos; --i) {
+        desc->targets_[i] = desc->targets_[i - 1];
+      }
+      desc->targets_[pos] = target;
+      if (count < desc->capacity_) {
+        desc->SetSize(count + 1);
+        return;
+      }
+      target = last;
+    }
+  }
+
+  /**
+   * @brief Perform a PMwCAS operation and finish it unless group commits defer
+   * it.
+   *
+   * @param conflict An optional output of the target causing a failure.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   */
+  auto RunPMwCAS(  //
+      PMwCASConflict *conflict)  //
+      -> bool;
+
+  /**
+   * @brief Perform a PMwCAS operation with overflow descriptors.
+   *
+   * @param conflict An optional output of the target causing a failure.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   */
+  auto StartChainedPMwCAS(  //
+      PMwCASConflict *conflict)  //
+      -> bool;
+
+  /**
+   * @brief Unlink and reset the overflow descriptors of this descriptor.
+   *
+   */
+  void ReleaseChain();
 
-  /// @brief The address of this descriptor for identification.
+  /**
+   * @brief Roll forward or roll back the targets of a crashed PMwCAS operation.
+   *
+   * @param succeeded A flag for indicating the PMwCAS operation succeeded.
+   * @param desc_word The descriptor word embedded into the targets.
+   * @param count The number of targets in this descriptor.
+   */
+  void RecoverTargets(  //
+      bool succeeded,
+      uint64_t desc_word,
+      size_t count);
+
+  /**
+   * @brief Call a given function for the copied targets of each descriptor in
+   * a chain.
+   *
+   * @tparam Func A class of the function.
+   * @param desc The head of the chain.
+   * @param desc_word A descriptor word of a target PMwCAS operation.
+   * @param func A function called with the targets and their number.
+   * @return The status of the PMwCAS operation observed after copying the
+   * last targets, or kCompleted if the operation has been completed.
+   */
+  template <class Func>
+  static auto VisitTargets(  //
+      PMwCASDescriptor *desc,
+      uint64_t desc_word,
+      Func &&func)  //
+      -> DescStatus;
+
+  /**
+   * @brief Perform a PMwCAS operation whose number of targets is fixed.
+   *
+   * @tparam kNum The number of targets in this descriptor.
+   * @param conflict An optional output of the target causing a failure.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   */
+  template <size_t kNum>
+  auto StartPMwCASWith(  //
+      PMwCASConflict *conflict)  //
+      -> bool;
+
+  /**
+   * @brief Dispatch a PMwCAS operation to the one unrolled for its targets.
+   *
+   * @tparam kNums Candidates of the number of targets.
+   * @param count The number of targets in this descriptor.
+   * @param conflict An optional output of the target causing a failure.
+   * @retval true if a PMwCAS operation succeeds.
+   * @retval false if a PMwCAS operation fails.
+   */
+  template <size_t... kNums>
+  auto DispatchPMwCAS(  //
+      size_t count,
+      PMwCASConflict *conflict,
+      std::index_sequence<kNums...>)  //
+      -> bool;
+
+  /**
+   * @brief Write a target into this descriptor without searching duplicates.
+   *
+   * @tparam T A class of a target.
+   * @param pos The position of the target.
+   * @param entry A target word.
+   * @throws std::invalid_argument if the target is not in the pmemobj pool of
+   * the first target.
+   */
+  template <class T>
+  void
+  SetTarget(  //
+      const size_t pos,
+      const PMwCASEntry<T> &entry)
+  {
+    if (persistent_) {
+      if (pos == 0) {
+        SetTargetPool(entry.addr);
+      } else {
+        CheckTargetPool(entry.addr);
+      }
+    }
+    targets_[pos] = PMwCASTarget{entry.addr, entry.old_val, entry.new_val, entry.fence};
+  }
+
+  /**
+   * @brief Set the number of targets without changing the other states.
+   *
+   * @param count The number of targets.
+   * @note Only the owner thread can call this function when there is no
+   * started PMwCAS operation.
+   */
+  void
+  SetSize(  //
+      const size_t count)
+  {
+    const auto state = state_.load(std::memory_order_relaxed) & ~kCountMask;
+    state_.store(state | (count << kCountShift), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Record the pmemobj pool of the first target for recovery.
+   *
+   * @param addr The address of the first target.
+   */
+  void SetTargetPool(  //
+      const void *addr);
+
+  /**
+   * @brief Check that a target is in the recorded pmemobj pool.
+   *
+   * @param addr The address of a target.
+   * @throws std::invalid_argument if the target is in another pool.
+   */
+  void CheckTargetPool(  //
+      const void *addr) const;
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  /// @brief The sequence number, the number of helping threads, the number of
+  /// targets, and progress state of a PMwCAS operation.
+  std::atomic_uint64_t state_{DescStatus::kCompleted};
+
+  /// @brief The virtual address of this descriptor with a PMwCAS flag.
+  /// @note Target words embed this address with the current sequence number.
+  /// This address is persisted with each PMwCAS operation, so recovery can
+  /// find embedded words even if the pool is mapped to another address.
   uint64_t desc_addr_{kPMwCASFlag};
 
+  /// @brief The virtual address of the next descriptor in a chain.
+  /// @note An overflow descriptor of a running chain has the descriptor word
+  /// of its head in `desc_addr_` instead of its own address.
+  uint64_t next_addr_{0};
+
+  /// @brief The lower bits of the UUID of the pmemobj pool containing targets.
+  uint64_t pool_uuid_lo_{0};
+
+  /// @brief The virtual address of the pool containing targets.
+  /// @note Recovery translates target addresses by the offsets from this base.
+  uint64_t pool_addr_{0};
+
+  /// @brief The maximum number of targets in this descriptor.
+  uint32_t capacity_{kPMwCASCapacity};
+
+  /// @brief A flag for indicating this descriptor is on persistent memory.
+  bool persistent_{true};
+
   /// @brief Target instances of PMwCAS.
+  /// @note A descriptor with a smaller capacity only holds the first
+  /// `capacity_` targets, and its trailing memory may not be allocated. Since
+  /// the header and each target take 48 and 24 bytes, a descriptor with the
+  /// default capacity fits in one PMEM line.
   PMwCASTarget targets_[kPMwCASCapacity];
 };
 
@@ -18,6 +18,7 @@
 #define PMEM_ATOMIC_UTILITY_HPP
 
 // C++ standard libraries
+#include <array>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
@@ -47,6 +48,55 @@ constexpr uint64_t kPMwCASFlag = 0b1UL << 62UL;
 /// @brief A flag for indicating intermediate states.
 constexpr uint64_t kIsIntermediate = kDirtyFlag | kPMwCASFlag;
 
+/// @brief The length of double-width words for PCAS in bytes.
+constexpr size_t kWideWordSize = 2 * kWordSize;
+
+/**
+ * @brief Policies for waiting for intermediate states to be resolved.
+ *
+ */
+enum class BackoffPolicy : uint8_t {
+  /// @brief Sleep for a back-off time.
+  kSleep = 0,
+  /// @brief Spin with exponentially increasing pause instructions.
+  kPause,
+  /// @brief Wait for a write to the target cache line by umonitor/umwait.
+  kWaitPkg,
+  /// @brief Wait on a futex until a writer resolves the target word.
+  kFutex,
+};
+
+/**
+ * @brief Events counted by statistics.
+ *
+ */
+enum class StatEvent : uint8_t {
+  /// @brief Successful PCAS operations.
+  kPCAS = 0,
+  /// @brief Failed PCAS operations.
+  kPCASFailure,
+  /// @brief Successful PMwCAS operations.
+  kPMwCAS,
+  /// @brief Failed PMwCAS operations.
+  kPMwCASFailure,
+  /// @brief Failures to embed descriptors after PMEM_ATOMIC_SPINLOCK_RETRY_NUM spins.
+  kEmbedRetryLimit,
+  /// @brief Reads of words in intermediate states.
+  kIntermediateRead,
+  /// @brief Back-offs for waiting for intermediate states.
+  kBackoff,
+  /// @brief Flushed cache lines.
+  kFlush,
+  /// @brief Fences for waiting for flushes.
+  kDrain,
+};
+
+/// @brief The number of events counted by statistics.
+constexpr size_t kStatEventNum = 9;
+
+/// @brief The number of latency buckets (the i-th one has [2^i, 2^(i+1)) ns).
+constexpr size_t kLatencyBucketNum = 64;
+
 /*##############################################################################
  * Tuning parameters
  *############################################################################*/
@@ -54,12 +104,92 @@ constexpr uint64_t kIsIntermediate = kDirtyFlag | kPMwCASFlag;
 /// @brief The maximum number of target words of PMwCAS.
 constexpr size_t kPMwCASCapacity = PMEM_ATOMIC_PMWCAS_CAPACITY;
 
+/// @brief The number of PMwCAS descriptors reserved for each thread.
+constexpr size_t kDescNumPerThread = PMEM_ATOMIC_DESCRIPTOR_NUM_PER_THREAD;
+
+/// @brief The maximum number of updates buffered by each thread in group commits.
+constexpr size_t kGroupCommitCapacity = PMEM_ATOMIC_GROUP_COMMIT_CAPACITY;
+
+/// @brief The number of worker threads for recovering PMwCAS descriptors.
+constexpr size_t kRecoveryThreadNum = PMEM_ATOMIC_RECOVERY_THREAD_NUM;
+
 /// @brief The maximum number of retries for preventing busy loops.
 constexpr size_t kRetryNum = PMEM_ATOMIC_SPINLOCK_RETRY_NUM;
 
 /// @brief A back-off time for preventing busy loops [us].
 constexpr std::chrono::microseconds kBackOffTime{PMEM_ATOMIC_BACKOFF_TIME};
 
+#ifdef PMEM_ATOMIC_USE_DIRTY_FLAG
+/// @brief Use dirty flags to hide unpersisted values from other threads.
+constexpr bool kUseDirtyFlag = true;
+#else
+/// @brief Do not use dirty flags, so other threads may read unpersisted values.
+constexpr bool kUseDirtyFlag = false;
+#endif
+
+#ifdef PMEM_ATOMIC_HELP_PMWCAS
+/// @brief Help conflicting PMwCAS operations to complete instead of waiting.
+constexpr bool kHelpPMwCAS = true;
+#else
+/// @brief Wait for conflicting PMwCAS operations to complete.
+constexpr bool kHelpPMwCAS = false;
+#endif
+
+#ifdef PMEM_ATOMIC_ENABLE_STATS
+/// @brief Count events and latency in hot paths.
+constexpr bool kEnableStats = true;
+#else
+/// @brief Do not count any events.
+constexpr bool kEnableStats = false;
+#endif
+
+#ifdef PMEM_ATOMIC_SORT_PMWCAS_TARGETS
+/// @brief Embed PMwCAS descriptors in ascending address order.
+constexpr bool kSortPMwCASTargets = true;
+#else
+/// @brief Embed PMwCAS descriptors in the order of registration.
+constexpr bool kSortPMwCASTargets = false;
+#endif
+
+#ifdef PMEM_ATOMIC_ENABLE_CRASH_INJECTION
+/// @brief Trace flushes and fences to simulate crashes for testing.
+constexpr bool kEnableCrashInjection = true;
+#else
+/// @brief Do not trace any flushes and fences.
+constexpr bool kEnableCrashInjection = false;
+#endif
+
+/*##############################################################################
+ * Global utility classes
+ *############################################################################*/
+
+/**
+ * @brief A snapshot of statistics.
+ *
+ */
+struct Stats {
+  /// @brief The number of each event.
+  std::array<uint64_t, kStatEventNum> counts{};
+
+  /// @brief A histogram of latency of PMwCAS operations.
+  std::array<uint64_t, kLatencyBucketNum> pmwcas_latency{};
+
+  /// @brief A histogram of latency of back-offs.
+  std::array<uint64_t, kLatencyBucketNum> backoff_latency{};
+
+  /**
+   * @param event A target event.
+   * @return The number of the event.
+   */
+  [[nodiscard]] constexpr auto
+  Get(  //
+      const StatEvent event) const  //
+      -> uint64_t
+  {
+    return counts[static_cast<size_t>(event)];
+  }
+};
+
 /*##############################################################################
  * Global utility functions
  *############################################################################*/
@@ -22,10 +22,9 @@
 #include <cstdint>
 #include <memory>
 
-// external system libraries
-#include <libpmem.h>
-
 // local sources
+#include "pmem/atomic/component/group_commit.hpp"
+#include "pmem/atomic/component/stats.hpp"
 #include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic
@@ -46,16 +45,20 @@ PCAS<uint64_t>(  //
 
   const auto orig_expected = expected;
   auto *word_addr = reinterpret_cast<std::atomic_uint64_t *>(addr);
-  auto dirty_v = desired | kDirtyFlag;
-  while (!word_addr->compare_exchange_weak(expected, dirty_v, kMORelax, failure)) {
+  const auto new_v = kUseDirtyFlag ? desired | kDirtyFlag : desired;
+  const auto cas_order = kUseDirtyFlag ? kMORelax : success;
+  while (!word_addr->compare_exchange_weak(expected, new_v, cas_order, failure)) {
     if (expected & kDirtyFlag) {
       component::ResolveIntermediateState(word_addr, expected);
     }
-    if (expected != orig_expected) return false;
+    if (expected != orig_expected) {
+      component::CountEvent(StatEvent::kPCASFailure);
+      return false;
+    }
   }
 
-  pmem_persist(addr, kWordSize);
-  word_addr->compare_exchange_strong(dirty_v, desired, success, kMORelax);
+  component::PersistWord(word_addr, new_v, success);
+  component::CountEvent(StatEvent::kPCAS);
   return true;
 }
 
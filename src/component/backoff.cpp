@@ -0,0 +1,226 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/backoff.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// system libraries
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// external libraries
+#include "lock/common.hpp"
+
+// local sources
+#include "pmem/atomic/component/stats.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+namespace
+{
+/*##############################################################################
+ * Local constants
+ *############################################################################*/
+
+/// @brief The maximum number of pause instructions between two loads.
+constexpr size_t kMaxPauseNum = 1024;
+
+/// @brief The maximum time of each umwait instruction in TSC cycles.
+constexpr uint64_t kUMWaitCycles = 10000;
+
+/// @brief A control value of umwait for selecting the faster C0.1 state.
+constexpr uint32_t kUMWaitC01 = 1;
+
+/*##############################################################################
+ * Local variables
+ *############################################################################*/
+
+/// @brief The number of threads waiting on futexes.
+std::atomic_size_t futex_waiter_num{0};
+
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+/**
+ * @param word_addr An address of a target word.
+ * @return The address of the upper half of the word, which has control bits.
+ */
+auto
+GetUpperHalf(  //
+    const std::atomic_uint64_t *word_addr)  //
+    -> uint32_t *
+{
+  // x86_64 is little endian
+  return reinterpret_cast<uint32_t *>(const_cast<std::atomic_uint64_t *>(word_addr)) + 1;
+}
+
+/**
+ * @brief Spin with exponentially increasing pause instructions.
+ *
+ * @param word_addr An address of a target word.
+ * @param word The current value of the word.
+ * @param deadline The time to give up waiting.
+ */
+void
+SpinWithPause(  //
+    const std::atomic_uint64_t *word_addr,
+    const uint64_t word,
+    const std::chrono::steady_clock::time_point deadline)
+{
+  for (size_t n = 1; word_addr->load(std::memory_order_relaxed) == word;
+       n = std::min(n * 2, kMaxPauseNum)) {
+    for (size_t i = 0; i < n; ++i) {
+      CPP_UTILITY_SPINLOCK_HINT
+    }
+    if (std::chrono::steady_clock::now() >= deadline) return;
+  }
+}
+
+#if defined(__x86_64__)
+/**
+ * @retval true if the processor supports umonitor/umwait.
+ * @retval false otherwise.
+ */
+auto
+HasWaitPkg()  //
+    -> bool
+{
+  constexpr unsigned int kWaitPkgBit = 1U << 5U;
+
+  static const bool has_waitpkg = [] {
+    unsigned int eax{};
+    unsigned int ebx{};
+    unsigned int ecx{};
+    unsigned int edx{};
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 && (ecx & kWaitPkgBit) != 0;
+  }();
+  return has_waitpkg;
+}
+
+/**
+ * @brief Wait for a write to the cache line of a target word.
+ *
+ * @param word_addr An address of a target word.
+ * @param word The current value of the word.
+ * @param deadline The time to give up waiting.
+ */
+__attribute__((target("waitpkg"))) void
+WaitWithUMWait(  //
+    const std::atomic_uint64_t *word_addr,
+    const uint64_t word,
+    const std::chrono::steady_clock::time_point deadline)
+{
+  while (true) {
+    _umonitor(const_cast<std::atomic_uint64_t *>(word_addr));
+    if (word_addr->load(std::memory_order_relaxed) != word) return;
+    _umwait(kUMWaitC01, __rdtsc() + kUMWaitCycles);
+    if (word_addr->load(std::memory_order_relaxed) != word) return;
+    if (std::chrono::steady_clock::now() >= deadline) return;
+  }
+}
+#endif
+
+/**
+ * @brief Wait on the futex of a target word until a writer wakes this thread.
+ *
+ * @param word_addr An address of a target word.
+ * @param word The current value of the word.
+ */
+void
+WaitOnFutex(  //
+    const std::atomic_uint64_t *word_addr,
+    const uint64_t word)
+{
+  constexpr auto kNano = std::chrono::duration_cast<std::chrono::nanoseconds>(kBackOffTime);
+  constexpr long kNanoPerSec = 1000000000L;
+  const timespec timeout{kNano.count() / kNanoPerSec, kNano.count() % kNanoPerSec};
+
+  // the counter and word must be ordered with the ones in WakeFutexWaiters
+  futex_waiter_num.fetch_add(1, std::memory_order_seq_cst);
+  if (word_addr->load(std::memory_order_seq_cst) == word) {
+    // the kernel also returns immediately if the word has been modified
+    syscall(SYS_futex, GetUpperHalf(word_addr), FUTEX_WAIT_PRIVATE,
+            static_cast<uint32_t>(word >> 32U), &timeout, nullptr, 0);
+  }
+  futex_waiter_num.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+void
+Backoff(  //
+    const std::atomic_uint64_t *word_addr,
+    const uint64_t word)
+{
+  const auto begin = StartTimer();
+  const auto deadline = std::chrono::steady_clock::now() + kBackOffTime;
+  switch (backoff_policy.load(std::memory_order_relaxed)) {
+    case BackoffPolicy::kPause:
+      SpinWithPause(word_addr, word, deadline);
+      break;
+    case BackoffPolicy::kWaitPkg:
+#if defined(__x86_64__)
+      if (HasWaitPkg()) {
+        WaitWithUMWait(word_addr, word, deadline);
+        break;
+      }
+#endif
+      SpinWithPause(word_addr, word, deadline);
+      break;
+    case BackoffPolicy::kFutex:
+      WaitOnFutex(word_addr, word);
+      break;
+    case BackoffPolicy::kSleep:
+    default:
+      std::this_thread::sleep_for(kBackOffTime);
+      break;
+  }
+  CountEvent(StatEvent::kBackoff);
+  RecordLatency(LatencyType::kBackoff, begin);
+}
+
+void
+WakeFutexWaiters(  //
+    const std::atomic_uint64_t *word_addr)
+{
+  // pair with WaitOnFutex so that either a waiter or this thread sees the other
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (futex_waiter_num.load(std::memory_order_relaxed) == 0) return;
+  syscall(SYS_futex, GetUpperHalf(word_addr), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+}  // namespace dbgroup::pmem::atomic::component
@@ -21,25 +21,107 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <thread>
-
-// external system libraries
-#include <libpmem.h>
 
 // external libraries
 #include "lock/common.hpp"
 
 // local sources
+#include "pmem/atomic/component/backoff.hpp"
+#include "pmem/atomic/component/group_commit.hpp"
+#include "pmem/atomic/component/persist.hpp"
+#include "pmem/atomic/component/stats.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
 #include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic::component
 {
+namespace
+{
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+/**
+ * @brief Compare and swap a double-width word with cmpxchg16b.
+ *
+ * @param addr An address of a target word.
+ * @param expected An expected value.
+ * @param desired A desired value.
+ * @return The value of the word before this operation.
+ */
+auto
+SwapWideWord(  //
+    WideWord *addr,
+    const WideWord expected,
+    const WideWord desired)  //
+    -> WideWord
+{
+  return __sync_val_compare_and_swap(addr, expected, desired);
+}
+
+/**
+ * @param addr An address of a double-width word.
+ * @return The address of the upper half of the word, which has a dirty flag.
+ */
+auto
+GetUpperHalf(  //
+    WideWord *addr)  //
+    -> std::atomic_uint64_t *
+{
+  // x86_64 is little endian
+  return reinterpret_cast<std::atomic_uint64_t *>(addr) + 1;
+}
+
+/**
+ * @brief Persist a given double-width value if it includes a dirty flag.
+ *
+ * @param[in] addr An address of a target word.
+ * @param[in,out] word A word that may be dirty.
+ */
+void
+ResolveDirtyWideWord(  //
+    WideWord *addr,
+    WideWord &word)
+{
+  if (word & kWideDirtyFlag) {
+    CountEvent(StatEvent::kIntermediateRead);
+  }
+  while (word & kWideDirtyFlag) {
+    for (size_t i = 0; i < kRetryNum; ++i) {
+      CPP_UTILITY_SPINLOCK_HINT
+      word = SwapWideWord(addr, 0, 0);
+      if ((word & kWideDirtyFlag) == 0) return;
+    }
+
+    // only the upper half has the dirty flag, so wait for it to be modified
+    const auto orig_word = word;
+    Backoff(GetUpperHalf(addr), static_cast<uint64_t>(orig_word >> 64U));
+    word = SwapWideWord(addr, 0, 0);
+    if ((word & kWideDirtyFlag) == 0) return;
+    if (word != orig_word) continue;
+
+    Persist(addr, kWideWordSize);
+    const auto clean_word = word & ~kWideDirtyFlag;
+    if (SwapWideWord(addr, word, clean_word) == word) {
+      word = clean_word;
+      WakeWaiters(GetUpperHalf(addr));
+      return;
+    }
+  }
+}
+
+}  // namespace
+
 
 void
 ResolveIntermediateState(  //
     std::atomic_uint64_t *word_addr,
     uint64_t &word)
 {
+  if (word & kIsIntermediate) {
+    CountEvent(StatEvent::kIntermediateRead);
+  }
   while (word & kIsIntermediate) {
     for (size_t i = 0; i < kRetryNum; ++i) {
       CPP_UTILITY_SPINLOCK_HINT
@@ -47,18 +129,107 @@ ResolveIntermediateState(  //
       if ((word & kIsIntermediate) == 0) return;
     }
 
+    if ((word & kPMwCASFlag) && DescriptorPool::RecoverEmbedded(word)) {
+      // the descriptor has been left since restart, so recover it
+      word = word_addr->load(kMORelax);
+      continue;
+    }
+
+    if constexpr (kHelpPMwCAS) {
+      if ((word & kPMwCASFlag) && PMwCASDescriptor::HelpPMwCAS(word)) {
+        // complete the PMwCAS operation instead of waiting for its owner
+        word = word_addr->load(kMORelax);
+        continue;
+      }
+    }
+
+    if (tls_group_commit.IsActive() && tls_group_commit.Contains(word_addr, word)) {
+      // this thread has written the dirty word, so commit it instead of waiting
+      tls_group_commit.Commit();
+      word = word_addr->load(kMORelax);
+      continue;
+    }
+
     const auto orig_word = word;
-    std::this_thread::sleep_for(kBackOffTime);
+    Backoff(word_addr, orig_word);
     word = word_addr->load(kMORelax);
     if ((word & kIsIntermediate) == 0) return;
     if ((word & kPMwCASFlag) || word != orig_word) continue;
 
-    pmem_persist(word_addr, kWordSize);
+    Persist(word_addr, kWordSize);
     if (word_addr->compare_exchange_strong(word, word & ~kDirtyFlag, kMORelax, kMORelax)) {
       word &= ~kDirtyFlag;
+      WakeWaiters(word_addr);
+      return;
+    }
+  }
+}
+
+void
+ReadLogicalValue(  //
+    const std::atomic_uint64_t *word_addr,
+    uint64_t &word)
+{
+  if (word & kIsIntermediate) {
+    CountEvent(StatEvent::kIntermediateRead);
+  }
+  while (word & kPMwCASFlag) {
+    if (DescriptorPool::RecoverEmbedded(word)) {
+      // descriptors left since restart must be recovered before reading them
+      word = word_addr->load(std::memory_order_acquire);
+      continue;
+    }
+
+    uint64_t val{};
+    if (PMwCASDescriptor::ReadTarget(word, word_addr, val)) {
+      word = val;
       return;
     }
+
+    // the PMwCAS operation has been completed, so retry reading
+    CPP_UTILITY_SPINLOCK_HINT
+    word = word_addr->load(std::memory_order_acquire);
+  }
+  word &= ~kDirtyFlag;
+}
+
+auto
+LoadWideWord(  //
+    void *addr)  //
+    -> WideWord
+{
+  auto *wide_addr = static_cast<WideWord *>(addr);
+  auto word = SwapWideWord(wide_addr, 0, 0);  // cmpxchg16b is the only atomic load
+  ResolveDirtyWideWord(wide_addr, word);
+  return word;
+}
+
+auto
+CASWideWord(  //
+    void *addr,
+    WideWord &expected,
+    const WideWord desired)  //
+    -> bool
+{
+  auto *wide_addr = static_cast<WideWord *>(addr);
+  const auto orig_expected = expected;
+  const auto new_v = kUseDirtyFlag ? desired | kWideDirtyFlag : desired;
+  while (true) {
+    const auto prev = SwapWideWord(wide_addr, expected, new_v);
+    if (prev == expected) break;
+    expected = prev;
+    if (expected & kWideDirtyFlag) {
+      ResolveDirtyWideWord(wide_addr, expected);
+    }
+    if (expected != orig_expected) return false;
+  }
+
+  Persist(addr, kWideWordSize);
+  if constexpr (kUseDirtyFlag) {
+    SwapWideWord(wide_addr, new_v, desired);
+    WakeWaiters(GetUpperHalf(wide_addr));
   }
+  return true;
 }
 
 template <>
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/crash_injection.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// local sources
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+namespace
+{
+/*##############################################################################
+ * Local types
+ *############################################################################*/
+
+/**
+ * @brief A region whose durable image is tracked.
+ *
+ */
+struct CrashRegion {
+  /// @brief The head address of this region.
+  std::byte *addr{nullptr};
+
+  /// @brief The contents of this region that survive a crash.
+  std::vector<std::byte> image{};
+};
+
+/**
+ * @brief A cache line that has been flushed but not fenced yet.
+ *
+ */
+struct FlushedLine {
+  /// @brief The head address of this line.
+  uintptr_t addr{};
+
+  /// @brief The contents of this line at the flush.
+  std::array<std::byte, kCacheLineSize> data{};
+};
+
+/*##############################################################################
+ * Local variables
+ *############################################################################*/
+
+/// @brief A flag for indicating some regions are tracked.
+std::atomic_bool tracing{false};
+
+/// @brief A mutex for the following variables.
+std::mutex crash_mtx{};
+
+/// @brief Tracked regions.
+std::vector<CrashRegion> regions{};
+
+/// @brief Flushed lines that will be durable at the next fence.
+std::vector<FlushedLine> pending{};
+
+/// @brief The number of fences since a crash was armed.
+size_t fence_cnt{0};
+
+/// @brief The fence point at which a crash is injected.
+size_t crash_point{0};
+
+/// @brief A flag for indicating a crash is armed.
+bool armed{false};
+
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+/**
+ * @brief Reflect a flushed line to the durable images of tracked regions.
+ *
+ * @param line A flushed line.
+ */
+void
+ApplyLine(  //
+    const FlushedLine &line)
+{
+  for (auto &&region : regions) {
+    const auto head = reinterpret_cast<uintptr_t>(region.addr);
+    const auto begin = std::max(head, line.addr);
+    const auto end = std::min(head + region.image.size(), line.addr + kCacheLineSize);
+    if (begin >= end) continue;
+    std::memcpy(&(region.image[begin - head]), &(line.data[begin - line.addr]), end - begin);
+  }
+}
+
+}  // namespace
+
+/*##############################################################################
+ * Utilities for crash injection
+ *############################################################################*/
+
+void
+RegisterCrashRegion(  //
+    void *addr,
+    const size_t size)
+{
+  auto *head = static_cast<std::byte *>(addr);
+  const std::lock_guard guard{crash_mtx};
+  regions.emplace_back(CrashRegion{head, std::vector<std::byte>(head, head + size)});
+  tracing.store(true, std::memory_order_relaxed);
+}
+
+void
+ArmCrash(  //
+    const size_t fence_num)
+{
+  const std::lock_guard guard{crash_mtx};
+  fence_cnt = 0;
+  crash_point = fence_num;
+  armed = true;
+}
+
+auto
+DisarmCrash()  //
+    -> size_t
+{
+  const std::lock_guard guard{crash_mtx};
+  armed = false;
+  return fence_cnt;
+}
+
+void
+RestoreDurableImage()
+{
+  const std::lock_guard guard{crash_mtx};
+  for (auto &&region : regions) {
+    std::memcpy(region.addr, region.image.data(), region.image.size());
+  }
+  regions.clear();
+  pending.clear();
+  armed = false;
+  tracing.store(false, std::memory_order_relaxed);
+}
+
+void
+TraceFlush(  //
+    const void *addr,
+    const size_t size)
+{
+  if (!tracing.load(std::memory_order_relaxed)) return;
+
+  // copy the flushed lines because later stores may not be written back
+  const auto begin = reinterpret_cast<uintptr_t>(addr) & ~(kCacheLineSize - 1);
+  const auto end = reinterpret_cast<uintptr_t>(addr) + size;
+  const std::lock_guard guard{crash_mtx};
+  for (auto line = begin; line < end; line += kCacheLineSize) {
+    auto &flushed = pending.emplace_back(FlushedLine{line, {}});
+    std::memcpy(flushed.data.data(), reinterpret_cast<const void *>(line), kCacheLineSize);
+  }
+}
+
+void
+TraceDrain()
+{
+  if (!tracing.load(std::memory_order_relaxed)) return;
+
+  const std::lock_guard guard{crash_mtx};
+  if (armed && fence_cnt == crash_point) {
+    armed = false;
+    throw SimulatedCrash{};
+  }
+  for (const auto &line : pending) {
+    ApplyLine(line);
+  }
+  pending.clear();
+  ++fence_cnt;
+}
+
+}  // namespace dbgroup::pmem::atomic::component
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/group_commit.hpp"
+
+// C++ standard libraries
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// local sources
+#include "pmem/atomic/component/backoff.hpp"
+#include "pmem/atomic/component/common.hpp"
+#include "pmem/atomic/component/persist.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+/*##############################################################################
+ * Public destructors
+ *############################################################################*/
+
+GroupCommitBuffer::~GroupCommitBuffer()
+{
+  if (word_count_ > 0 || desc_count_ > 0) {
+    Commit();
+  }
+}
+
+/*##############################################################################
+ * Public utilities
+ *############################################################################*/
+
+void
+GroupCommitBuffer::AddDirtyWord(  //
+    std::atomic_uint64_t *word_addr,
+    const uint64_t dirty_word)
+{
+  if (word_count_ >= kGroupCommitCapacity) {
+    Commit();
+  }
+  Flush(word_addr, kWordSize);
+  word_addrs_[word_count_] = word_addr;
+  dirty_words_[word_count_++] = dirty_word;
+}
+
+void
+GroupCommitBuffer::AddDescriptor(  //
+    PMwCASDescriptor *desc)
+{
+  for (size_t i = 0; i < desc_count_; ++i) {
+    if (descs_[i] == desc) return;
+  }
+  if (desc_count_ >= kGroupCommitCapacity) {
+    Commit();
+  }
+  descs_[desc_count_++] = desc;
+}
+
+auto
+GroupCommitBuffer::Contains(  //
+    const std::atomic_uint64_t *word_addr,
+    const uint64_t word) const  //
+    -> bool
+{
+  for (size_t i = 0; i < word_count_; ++i) {
+    if (word_addrs_[i] == word_addr && dirty_words_[i] == word) return true;
+  }
+  return false;
+}
+
+void
+GroupCommitBuffer::Commit()
+{
+  Drain();
+
+  // all the buffered words are durable, so other threads can read them
+  for (size_t i = 0; i < word_count_; ++i) {
+    auto dirty_word = dirty_words_[i];
+    word_addrs_[i]->compare_exchange_strong(dirty_word, dirty_word & ~kDirtyFlag,
+                                            std::memory_order_release, kMORelax);
+    WakeWaiters(word_addrs_[i]);
+  }
+  word_count_ = 0;
+
+  // the descriptors may have been reused, so only pending ones are finished
+  for (size_t i = 0; i < desc_count_; ++i) {
+    descs_[i]->FinishPMwCAS();
+  }
+  desc_count_ = 0;
+}
+
+}  // namespace dbgroup::pmem::atomic::component
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/persist.hpp"
+
+// C++ standard libraries
+#include <cstdlib>
+#include <string_view>
+
+// system libraries
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+// external system libraries
+#include <libpmem.h>
+
+namespace dbgroup::pmem::atomic::component
+{
+
+auto
+DetectFlushType()  //
+    -> FlushType
+{
+  // follow the convention of libpmem to override the detection
+  const auto *no_flush = std::getenv("PMEM_NO_FLUSH");
+  if (no_flush != nullptr && std::string_view{no_flush} == "1") return FlushType::kNone;
+  const bool force_flush = no_flush != nullptr && std::string_view{no_flush} == "0";
+  if (!force_flush && pmem_has_auto_flush() == 1) return FlushType::kNone;
+
+#if defined(__x86_64__)
+  constexpr unsigned int kCLFlushOptBit = 1U << 23U;
+  constexpr unsigned int kCLWBBit = 1U << 24U;
+
+  unsigned int eax{};
+  unsigned int ebx{};
+  unsigned int ecx{};
+  unsigned int edx{};
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0) {
+    if (ebx & kCLWBBit) return FlushType::kCLWB;
+    if (ebx & kCLFlushOptBit) return FlushType::kCLFlushOpt;
+  }
+  return FlushType::kCLFlush;
+#else
+  return FlushType::kLibPmem;
+#endif
+}
+
+}  // namespace dbgroup::pmem::atomic::component
@@ -22,71 +22,129 @@
 #include <cstddef>
 #include <cstdint>
 
-// external system libraries
-#include <libpmem.h>
-#include <libpmemobj.h>
-
 // external libraries
 #include "lock/common.hpp"
 
 // local sources
+#include "pmem/atomic/component/backoff.hpp"
+#include "pmem/atomic/component/group_commit.hpp"
+#include "pmem/atomic/component/persist.hpp"
+#include "pmem/atomic/component/stats.hpp"
 #include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic::component
 {
 
+auto
+PMwCASTarget::Load() const  //
+    -> uint64_t
+{
+  return GetWordAddr()->load(kMORelax);
+}
+
+auto
+PMwCASTarget::MayHaveExpectedValue() const  //
+    -> bool
+{
+  const auto word = GetWordAddr()->load(kMORelax);
+  return (word & kPMwCASFlag) || (word & ~kDirtyFlag) == old_val_;
+}
+
 auto
 PMwCASTarget::EmbedDescriptor(  //
     const uint64_t desc_addr)   //
     -> bool
 {
-  auto *addr = static_cast<std::atomic_uint64_t *>(pmemobj_direct(oid_));
+  auto *addr = GetWordAddr();
   for (size_t i = 0; true; ++i) {
     auto expected = addr->load(kMORelax);
     if (expected == old_val_
-        && addr->compare_exchange_strong(expected, desc_addr, fence_, kMORelax)) {
+        && addr->compare_exchange_strong(expected, desc_addr, GetFence(), kMORelax)) {
       return true;
     }
-    if ((expected & kIsIntermediate) == 0 || i >= kRetryNum) return false;
+    if (expected == desc_addr) return true;  // helping threads have embedded it
+    if ((expected & kIsIntermediate) == 0) return false;
+    if (i >= kRetryNum) {
+      CountEvent(StatEvent::kEmbedRetryLimit);
+      return false;
+    }
     CPP_UTILITY_SPINLOCK_HINT
   }
 }
 
+auto
+PMwCASTarget::EmbedDescriptorInHTM(  //
+    const uint64_t desc_addr)        //
+    -> bool
+{
+  if (GetWordAddr()->load(kMORelax) != old_val_) return false;
+  GetWordAddr()->store(desc_addr, kMORelax);
+  return true;
+}
+
+auto
+PMwCASTarget::UpdateInHTM(  //
+    const bool dirty)       //
+    -> bool
+{
+  if (GetWordAddr()->load(kMORelax) != old_val_) return false;
+  GetWordAddr()->store(dirty ? new_val_ | kDirtyFlag : new_val_, kMORelax);
+  return true;
+}
+
 void
-PMwCASTarget::Flush()
+PMwCASTarget::ClearDirtyFlag(  //
+    const bool defer)
 {
-  auto *addr = static_cast<std::atomic_uint64_t *>(pmemobj_direct(oid_));
-  pmem_flush(addr, kWordSize);
+  auto dirty_v = new_val_ | kDirtyFlag;
+  if (defer) {
+    tls_group_commit.AddDirtyWord(GetWordAddr(), dirty_v);
+    return;
+  }
+  GetWordAddr()->compare_exchange_strong(dirty_v, new_val_, GetFence(), kMORelax);
+  WakeWaiters(GetWordAddr());
 }
+
 void
-PMwCASTarget::Redo()
+PMwCASTarget::Redo(  //
+    uint64_t desc_addr)
 {
-  auto *addr = static_cast<std::atomic_uint64_t *>(pmemobj_direct(oid_));
-  addr->store(new_val_, kMORelax);
-  pmem_flush(addr, kWordSize);
+  if constexpr (kHelpPMwCAS) {
+    // other threads may have already completed this target
+    GetWordAddr()->compare_exchange_strong(desc_addr, new_val_, kMORelax, kMORelax);
+  } else {
+    GetWordAddr()->store(new_val_, kMORelax);
+  }
+  WakeWaiters(GetWordAddr());
 }
 
 void
-PMwCASTarget::Undo()
+PMwCASTarget::Undo(  //
+    uint64_t desc_addr)
 {
-  auto *addr = static_cast<std::atomic_uint64_t *>(pmemobj_direct(oid_));
-  addr->store(old_val_, kMORelax);
-  pmem_flush(addr, kWordSize);
+  if constexpr (kHelpPMwCAS) {
+    // other threads may have already completed this target
+    GetWordAddr()->compare_exchange_strong(desc_addr, old_val_, kMORelax, kMORelax);
+  } else {
+    GetWordAddr()->store(old_val_, kMORelax);
+  }
+  WakeWaiters(GetWordAddr());
 }
 
 void
 PMwCASTarget::Recover(  //
     const bool succeeded,
-    uint64_t desc_addr)
+    uint64_t desc_addr,
+    void *target_addr) const
 {
-  auto *addr = static_cast<std::atomic_uint64_t *>(pmemobj_direct(oid_));
+  auto *addr = static_cast<std::atomic_uint64_t *>(target_addr);
   const auto word = addr->load(kMORelax);
   if (word & kDirtyFlag) {
     addr->store(word & ~kDirtyFlag, kMORelax);
-    pmem_flush(addr, kWordSize);
+    Flush(addr, kWordSize);
   } else if (word == desc_addr) {
     addr->store(succeeded ? new_val_ : old_val_, kMORelax);
-    pmem_flush(addr, kWordSize);
+    Flush(addr, kWordSize);
   }
 }
 
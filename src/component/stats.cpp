@@ -0,0 +1,166 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/stats.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// local sources
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic::component
+{
+namespace
+{
+/*##############################################################################
+ * Local constants
+ *############################################################################*/
+
+/// @brief An alias of std::memory_order_relaxed.
+constexpr auto kMORelax = std::memory_order_relaxed;
+
+/*##############################################################################
+ * Local variables
+ *############################################################################*/
+
+/// @brief A mutex for the registry of per-thread statistics.
+std::mutex registry_mtx{};
+
+/// @brief Statistics of running threads.
+std::vector<const ThreadStats *> registry{};
+
+/// @brief The sums of statistics of exited threads.
+Stats retired{};
+
+/// @brief The sums of statistics at the last reset.
+Stats baseline{};
+
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+/**
+ * @brief Add statistics of a thread to given sums.
+ *
+ * @param[in] stats Statistics of a thread.
+ * @param[in,out] sum The sums of statistics.
+ */
+void
+Accumulate(  //
+    const ThreadStats &stats,
+    Stats &sum)
+{
+  for (size_t i = 0; i < kStatEventNum; ++i) {
+    sum.counts[i] += stats.counts[i].load(kMORelax);
+  }
+  for (size_t i = 0; i < kLatencyBucketNum; ++i) {
+    sum.pmwcas_latency[i] += stats.latency[0][i].load(kMORelax);
+    sum.backoff_latency[i] += stats.latency[1][i].load(kMORelax);
+  }
+}
+
+/**
+ * @brief Statistics of a thread registered during its lifetime.
+ *
+ */
+struct LocalStats {
+  LocalStats()
+  {
+    const std::lock_guard guard{registry_mtx};
+    registry.emplace_back(&stats);
+  }
+
+  LocalStats(const LocalStats &) = delete;
+  LocalStats(LocalStats &&) = delete;
+
+  auto operator=(const LocalStats &) -> LocalStats & = delete;
+  auto operator=(LocalStats &&) -> LocalStats & = delete;
+
+  ~LocalStats()
+  {
+    // keep the counts of this thread after it exits
+    const std::lock_guard guard{registry_mtx};
+    Accumulate(stats, retired);
+    registry.erase(std::find(registry.begin(), registry.end(), &stats));
+  }
+
+  /// @brief Statistics of this thread.
+  ThreadStats stats{};
+};
+
+/**
+ * @return The sum of statistics of all the threads.
+ */
+auto
+CollectStats()  //
+    -> Stats
+{
+  const std::lock_guard guard{registry_mtx};
+  auto sum = retired;
+  for (const auto *stats : registry) {
+    Accumulate(*stats, sum);
+  }
+  return sum;
+}
+
+}  // namespace
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+auto
+GetLocalStats()  //
+    -> ThreadStats &
+{
+  // do not use thread IDs because they may be exhausted by worker threads
+  thread_local LocalStats local{};
+  return local.stats;
+}
+
+auto
+GetStats()  //
+    -> Stats
+{
+  auto stats = CollectStats();
+  const std::lock_guard guard{registry_mtx};
+  for (size_t i = 0; i < kStatEventNum; ++i) {
+    stats.counts[i] -= baseline.counts[i];
+  }
+  for (size_t i = 0; i < kLatencyBucketNum; ++i) {
+    stats.pmwcas_latency[i] -= baseline.pmwcas_latency[i];
+    stats.backoff_latency[i] -= baseline.backoff_latency[i];
+  }
+  return stats;
+}
+
+void
+ResetStats()
+{
+  const auto stats = CollectStats();
+  const std::lock_guard guard{registry_mtx};
+  baseline = stats;
+}
+
+}  // namespace dbgroup::pmem::atomic::component
@@ -18,14 +18,29 @@
 #include "pmem/atomic/descriptor_pool.hpp"
 
 // C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // system libraries
+#include <pthread.h>
+#include <sched.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <sys/types.h>
 
 // external system libraries
@@ -36,63 +51,554 @@
 #include "thread/id_manager.hpp"
 
 // local sources
+#include "pmem/atomic/component/persist.hpp"
+#include "pmem/atomic/component/stats.hpp"
 #include "pmem/atomic/pmwcas_descriptor.hpp"
+#include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic
 {
+namespace
+{
+/*##############################################################################
+ * Local constants
+ *############################################################################*/
+
+/// @brief The alignment of volatile descriptors.
+constexpr std::align_val_t kPMEMLineAlign{kPMEMLineSize};
+
+/// @brief A magic number for identifying descriptor pools ("PMWCASDP").
+constexpr uint64_t kPoolMagic = 0x504D574341534450UL;
+
+/// @brief The version of the layout of descriptor pools.
+/// @note Version 2 widened the sequence numbers in descriptor state words.
+constexpr uint64_t kPoolVersion = 2;
+
+/**
+ * @brief The recovery states of descriptors in lazily opened pools.
+ *
+ */
+enum RecoveryState : uint8_t {
+  kUnrecovered = 0,
+  kRecovering,
+  kRecovered,
+};
+
+/*##############################################################################
+ * Local types
+ *############################################################################*/
+
+/**
+ * @brief A descriptor that may have a started PMwCAS operation before restart.
+ *
+ */
+struct LazyDescriptor {
+  /// @brief The descriptor to be recovered.
+  PMwCASDescriptor *desc{nullptr};
+
+  /// @brief The recovery state of the descriptor.
+  std::atomic_uint8_t *state{nullptr};
+
+  /// @brief The maximum number of targets in the descriptor.
+  size_t capacity{kPMwCASCapacity};
+};
+
+/*##############################################################################
+ * Local variables
+ *############################################################################*/
+
+/// @brief A mutex for the registry of unrecovered descriptors.
+std::mutex lazy_mtx{};
+
+/// @brief Unrecovered descriptors indexed by the words embedded into targets.
+std::unordered_map<uint64_t, LazyDescriptor> lazy_descs{};
+
+/// @brief The number of registered unrecovered descriptors.
+std::atomic_size_t lazy_num{0};
+
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+/**
+ * @param pmem_path The path to a file or device on persistent memory.
+ * @return The NUMA node of the device or -1 if it cannot be detected.
+ */
+auto
+GetNUMANode(  //
+    const std::string &pmem_path)  //
+    -> int
+{
+  struct stat st {};
+  if (stat(pmem_path.c_str(), &st) != 0) return -1;
+
+  // devdax pools are character devices, and fsdax ones are on block devices
+  const auto is_dax = S_ISCHR(st.st_mode);
+  const auto dev = is_dax ? st.st_rdev : st.st_dev;
+  std::filesystem::path sys_path{is_dax ? "/sys/dev/char" : "/sys/dev/block"};
+  sys_path /= std::to_string(major(dev)) + ":" + std::to_string(minor(dev));
+
+  // partitions do not have their own device directories
+  for (const auto *rel_path : {"device/numa_node", "../device/numa_node"}) {
+    std::ifstream fin{sys_path / rel_path};
+    int node = -1;
+    if (fin >> node && node >= 0) return node;
+  }
+  return -1;
+}
+
+/**
+ * @param node A NUMA node.
+ * @return The CPUs of the given NUMA node.
+ */
+auto
+GetCPUs(  //
+    const int node)  //
+    -> std::vector<size_t>
+{
+  std::vector<size_t> cpus{};
+  std::ifstream fin{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+  std::string cpu_list{};
+  if (!std::getline(fin, cpu_list)) return cpus;
+
+  // parse a CPU list such as "0-3,8-11"
+  std::istringstream ss{cpu_list};
+  for (std::string range{}; std::getline(ss, range, ',');) {
+    if (range.empty()) continue;
+    const auto pos = range.find('-');
+    const size_t first = std::stoul(range.substr(0, pos));
+    const size_t last = (pos == std::string::npos) ? first : std::stoul(range.substr(pos + 1));
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.emplace_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+/**
+ * @brief Pin the current thread to the CPUs of a given NUMA node.
+ *
+ * @param node A NUMA node.
+ */
+void
+PinToNUMANode(  //
+    const int node)
+{
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (const auto cpu : GetCPUs(node)) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+  if (CPU_COUNT(&cpu_set) > 0) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+  }
+}
+
+/**
+ * @brief Recover a descriptor if no other thread has recovered it.
+ *
+ * @param entry A descriptor in a lazily opened pool.
+ */
+void
+RecoverLazily(  //
+    const LazyDescriptor &entry)
+{
+  auto *desc = entry.desc;
+  auto expected = static_cast<uint8_t>(kUnrecovered);
+  if (!entry.state->compare_exchange_strong(expected, kRecovering, std::memory_order_acquire)) {
+    // wait for another thread to recover the descriptor
+    while (entry.state->load(std::memory_order_acquire) != kRecovered) {
+      std::this_thread::yield();
+    }
+    return;
+  }
+
+  const auto pending = desc->IsPending();
+  const auto desc_word = desc->GetDescWord();
+  desc->Initialize(entry.capacity);
+  component::Drain();
+  entry.state->store(kRecovered, std::memory_order_release);
+  if (pending) {
+    const std::lock_guard guard{lazy_mtx};
+    lazy_num.fetch_sub(lazy_descs.erase(desc_word), std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+/*##############################################################################
+ * Internal types
+ *############################################################################*/
+
+/**
+ * @brief A header of a descriptor pool to check its configuration.
+ *
+ */
+struct alignas(kPMEMLineSize) DescriptorPool::PoolHeader {
+  /// @brief A magic number written after the other fields are persisted.
+  uint64_t magic;
+
+  /// @brief The version of the pool layout.
+  uint64_t version;
+
+  /// @brief The maximum number of targets in each descriptor.
+  uint64_t capacity;
+
+  /// @brief The number of descriptors reserved for each thread.
+  uint64_t desc_num_per_thread;
+
+  /// @brief A flag for indicating the pool has been closed cleanly.
+  uint64_t clean_shutdown;
+
+  /// @brief The number of thread slots (zero if created with the default).
+  uint64_t slot_num;
+};
+
 /*##############################################################################
  * Public constructors and descructors
  *############################################################################*/
 
 DescriptorPool::DescriptorPool(  //
     const std::string &pmem_path,
-    const std::string &layout_name)
+    const std::string &layout_name,
+    const size_t capacity,
+    const bool lazy_recovery)
+    : capacity_{capacity},
+      desc_size_{PMwCASDescriptor::GetSize(capacity)},
+      lazy_recovery_{lazy_recovery}
+{
+  if (capacity == 0 || capacity > kPMwCASCapacity) {
+    throw std::invalid_argument{"the capacity of descriptors is out of range."};
+  }
+  Open(pmem_path, layout_name, -1);
+}
+
+DescriptorPool::DescriptorPool(  //
+    const std::string &pmem_path,
+    ThreadSlots slots,
+    const std::string &layout_name,
+    const size_t capacity,
+    const bool lazy_recovery)
+    : capacity_{capacity},
+      desc_size_{PMwCASDescriptor::GetSize(capacity)},
+      slot_num_{slots.num},
+      slot_mapper_{std::move(slots.mapper)},
+      desc_num_{slots.num * kDescNumPerThread},
+      lazy_recovery_{lazy_recovery}
+{
+  if (slot_num_ == 0 || slot_num_ > ::dbgroup::thread::kMaxThreadNum) {
+    throw std::invalid_argument{"the number of thread slots is out of range."};
+  }
+  if (capacity == 0 || capacity > kPMwCASCapacity) {
+    throw std::invalid_argument{"the capacity of descriptors is out of range."};
+  }
+  Open(pmem_path, layout_name, -1);
+}
+
+DescriptorPool::DescriptorPool(  //
+    const std::vector<std::string> &pmem_paths,
+    const std::string &layout_name,
+    const size_t capacity,
+    const bool lazy_recovery)
+    : capacity_{capacity},
+      desc_size_{PMwCASDescriptor::GetSize(capacity)},
+      lazy_recovery_{lazy_recovery}
+{
+  if (pmem_paths.empty()) {
+    throw std::invalid_argument{"no paths are given for descriptor pools."};
+  }
+  if (capacity == 0 || capacity > kPMwCASCapacity) {
+    throw std::invalid_argument{"the capacity of descriptors is out of range."};
+  }
+
+  try {
+    for (size_t i = 0; i < pmem_paths.size(); ++i) {
+      const auto node = static_cast<int>(i);
+      Open(pmem_paths[i], layout_name, node);
+
+      // threads on this node use the corresponding pool
+      for (const auto cpu : GetCPUs(node)) {
+        if (cpu >= cpu_to_part_.size()) {
+          cpu_to_part_.resize(cpu + 1, 0);
+        }
+        cpu_to_part_[cpu] = static_cast<uint32_t>(i);
+      }
+    }
+  } catch (...) {
+    Close();
+    throw;
+  }
+}
+
+DescriptorPool::DescriptorPool(  //
+    [[maybe_unused]] const VolatileTag tag,
+    const size_t capacity)
+    : capacity_{capacity}, desc_size_{PMwCASDescriptor::GetSize(capacity)}
+{
+  if (capacity == 0 || capacity > kPMwCASCapacity) {
+    throw std::invalid_argument{"the capacity of descriptors is out of range."};
+  }
+
+  // zero-filled descriptors have no started PMwCAS operations
+  const auto size = desc_size_ * desc_num_;
+  auto *desc_pool = static_cast<std::byte *>(::operator new(size, kPMEMLineAlign));
+  std::memset(desc_pool, 0, size);
+  const Partition part{nullptr, nullptr, desc_pool};
+  for (size_t i = 0; i < desc_num_; ++i) {
+    GetDescriptor(part, i)->Initialize(capacity_, false);
+  }
+  partitions_.emplace_back(part);
+}
+
+DescriptorPool::~DescriptorPool()  //
+{
+  Close();
+}
+
+/*##############################################################################
+ * Public utility functions
+ *############################################################################*/
+
+auto
+DescriptorPool::Get(  //
+    const size_t k)     //
+    -> PMwCASDescriptor *
+{
+  const auto slot = slot_mapper_ ? slot_mapper_() : ::dbgroup::thread::IDManager::GetThreadID();
+  return GetInSlot(slot, k);
+}
+
+auto
+DescriptorPool::GetInSlot(  //
+    const size_t slot,
+    const size_t k)  //
+    -> PMwCASDescriptor *
+{
+  assert(k < kDescNumPerThread);
+  if (slot >= slot_num_) {
+    throw std::out_of_range{"the thread slot is out of range."};
+  }
+  const auto first = slot * kDescNumPerThread;
+  const auto &part = GetLocalPartition();
+  if (part.recovered != nullptr
+      && part.recovered[first + k].load(std::memory_order_acquire) != kRecovered) {
+    RecoverThreadDescriptors(part, first);
+  }
+  return GetDescriptor(part, first + k);
+}
+
+auto
+DescriptorPool::RecoverEmbedded(  //
+    const uint64_t desc_word)     //
+    -> bool
+{
+  if (lazy_num.load(std::memory_order_relaxed) == 0) return false;
+
+  LazyDescriptor entry{};
+  {
+    const std::lock_guard guard{lazy_mtx};
+    const auto iter = lazy_descs.find(desc_word);
+    if (iter == lazy_descs.end()) return false;
+    entry = iter->second;
+  }
+  RecoverLazily(entry);
+  return true;
+}
+
+/*##############################################################################
+ * Public statistics
+ *############################################################################*/
+
+auto
+DescriptorPool::GetStats()  //
+    -> Stats
+{
+  return component::GetStats();
+}
+
+void
+DescriptorPool::ResetStats()
+{
+  component::ResetStats();
+}
+
+/*##############################################################################
+ * Internal utility functions
+ *############################################################################*/
+
+auto
+DescriptorPool::GetLocalPartition() const  //
+    -> const Partition &
+{
+  if (partitions_.size() == 1) return partitions_.front();
+
+  const auto cpu = sched_getcpu();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_to_part_.size()) return partitions_.front();
+  return partitions_[cpu_to_part_[cpu]];
+}
+
+void
+DescriptorPool::Open(  //
+    const std::string &pmem_path,
+    const std::string &layout_name,
+    const int node)
 {
-  constexpr size_t kMaxThreadNum = ::dbgroup::thread::kMaxThreadNum;
-  constexpr size_t kDescPoolSize = sizeof(PMwCASDescriptor) * (kMaxThreadNum + 1);
-  constexpr size_t kPoolSize = kDescPoolSize + PMEMOBJ_MIN_POOL;
   constexpr mode_t kModeRW = S_IRUSR | S_IWUSR;
   constexpr uintptr_t kMask = kPMEMLineSize - 1;
+  constexpr size_t kDefaultSlotNum = ::dbgroup::thread::kMaxThreadNum;
+
+  const size_t desc_pool_size = desc_size_ * (desc_num_ + kDescNumPerThread);
+  const size_t root_size = kPMEMLineSize + sizeof(PoolHeader) + desc_pool_size;
+  const size_t pool_size = root_size + PMEMOBJ_MIN_POOL;
 
   // create/open a pool on persistent memory
   const auto *path = pmem_path.c_str();
   const auto *layout = layout_name.c_str();
-  pop_ = std::filesystem::exists(pmem_path) ? pmemobj_open(path, layout)
-                                            : pmemobj_create(path, layout, kPoolSize, kModeRW);
-  if (pop_ == nullptr) throw std::runtime_error{pmemobj_errormsg()};
+  auto *pop = std::filesystem::exists(pmem_path)
+                  ? pmemobj_open(path, layout)
+                  : pmemobj_create(path, layout, pool_size, kModeRW);
+  if (pop == nullptr) throw std::runtime_error{pmemobj_errormsg()};
 
-  // get the pointer to descriptors
-  auto &&root = pmemobj_root(pop_, kDescPoolSize);
+  // get the pointer to a header with the Intel Optane alignment
+  const auto is_new = pmemobj_root_size(pop) == 0;
+  auto &&root = pmemobj_root(pop, root_size);
   auto addr = reinterpret_cast<uintptr_t>(pmemobj_direct(root));
   if ((addr & kMask) > 0) {
-    // move the address to the Intel Optane alignment
     addr = (addr & ~kMask) + kPMEMLineSize;
   }
-  desc_pool_ = reinterpret_cast<PMwCASDescriptor *>(addr);
+  auto *header = reinterpret_cast<PoolHeader *>(addr);
+  Partition part{pop, header, reinterpret_cast<std::byte *>(header + 1)};
+
+  // check the pool has been created with the same layout and configuration
+  const auto slot_num = (slot_num_ == kDefaultSlotNum) ? 0 : slot_num_;
+  if (is_new) {
+    header->version = kPoolVersion;
+    header->capacity = capacity_;
+    header->desc_num_per_thread = kDescNumPerThread;
+    header->slot_num = slot_num;
+    component::Persist(header, sizeof(PoolHeader));
+    header->magic = kPoolMagic;
+    component::Persist(&(header->magic), kWordSize);
+  } else if (header->magic != kPoolMagic || header->version != kPoolVersion) {
+    // descriptors of older layouts are placed at other offsets
+    pmemobj_close(pop);
+    throw std::runtime_error{"the pool has been created with an unsupported layout."};
+  } else if (header->capacity != capacity_
+             || header->desc_num_per_thread != kDescNumPerThread
+             || header->slot_num != slot_num) {
+    pmemobj_close(pop);
+    throw std::runtime_error{"the pool has been created with a different configuration."};
+  }
 
-  // if the pool was on persistent memory, check for dirty descriptors
-  for (size_t i = 0; i < kMaxThreadNum; ++i) {
-    desc_pool_[i].Initialize();
+  // if the pool was not closed cleanly, check for dirty descriptors
+  if (header->clean_shutdown == 0) {
+    if (lazy_recovery_) {
+      PrepareLazyRecovery(part);
+    } else {
+      Recover(part, (node < 0) ? GetNUMANode(pmem_path) : node);
+    }
   }
-  pmem_drain();
+  header->clean_shutdown = 0;
+  component::Persist(&(header->clean_shutdown), kWordSize);
+  partitions_.emplace_back(part);
 }
 
-DescriptorPool::~DescriptorPool()
+void
+DescriptorPool::PrepareLazyRecovery(  //
+    Partition &part)
 {
-  if (pop_ != nullptr) {
-    pmemobj_close(pop_);
+  // only started PMwCAS operations may have embedded descriptors into targets
+  part.recovered = new std::atomic_uint8_t[desc_num_]{};
+  const std::lock_guard guard{lazy_mtx};
+  for (size_t i = 0; i < desc_num_; ++i) {
+    auto *desc = GetDescriptor(part, i);
+    if (!desc->IsPending()) continue;
+    const LazyDescriptor entry{desc, &(part.recovered[i]), capacity_};
+    if (lazy_descs.emplace(desc->GetDescWord(), entry).second) {
+      lazy_num.fetch_add(1, std::memory_order_relaxed);
+    }
   }
 }
 
-/*##############################################################################
- * Public utility functions
- *############################################################################*/
+void
+DescriptorPool::RecoverThreadDescriptors(  //
+    const Partition &part,
+    const size_t first) const
+{
+  // the descriptors of one thread may be chained, so recover them together
+  for (auto i = first; i < first + kDescNumPerThread; ++i) {
+    RecoverLazily(LazyDescriptor{GetDescriptor(part, i), &(part.recovered[i]), capacity_});
+  }
+}
 
-auto
-DescriptorPool::Get()  //
-    -> PMwCASDescriptor *
+void
+DescriptorPool::Recover(  //
+    const Partition &part,
+    const int node)
 {
-  return &(desc_pool_[::dbgroup::thread::IDManager::GetThreadID()]);
+  auto recover = [&](const size_t begin, const size_t end, const bool pin) {
+    if (pin && node >= 0) {
+      PinToNUMANode(node);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      GetDescriptor(part, i)->Initialize(capacity_);
+    }
+    component::Drain();
+  };
+
+  if constexpr (kRecoveryThreadNum <= 1) {
+    recover(0, desc_num_, false);
+  } else {
+    const size_t chunk_size = (desc_num_ + kRecoveryThreadNum - 1) / kRecoveryThreadNum;
+    std::vector<std::thread> threads{};
+    threads.reserve(kRecoveryThreadNum);
+    for (size_t begin = 0; begin < desc_num_; begin += chunk_size) {
+      threads.emplace_back(recover, begin, std::min(begin + chunk_size, desc_num_), true);
+    }
+    for (auto &&t : threads) {
+      t.join();
+    }
+  }
+}
+
+void
+DescriptorPool::Close()
+{
+  for (auto &&part : partitions_) {
+    if (part.pop == nullptr) {
+      ::operator delete(part.desc_pool, kPMEMLineAlign);
+      continue;
+    }
+
+    // unregister unrecovered descriptors
+    if (part.recovered != nullptr) {
+      const std::lock_guard guard{lazy_mtx};
+      for (auto iter = lazy_descs.begin(); iter != lazy_descs.end();) {
+        const auto *state = iter->second.state;
+        if (state < part.recovered || state >= part.recovered + desc_num_) {
+          ++iter;
+          continue;
+        }
+        iter = lazy_descs.erase(iter);
+        lazy_num.fetch_sub(1, std::memory_order_relaxed);
+      }
+      delete[] part.recovered;
+    }
+
+    // the pool is clean only if all the descriptors have completed PMwCAS
+    auto clean = true;
+    for (size_t i = 0; i < desc_num_ && clean; ++i) {
+      clean = !GetDescriptor(part, i)->IsPending();
+    }
+    if (clean) {
+      part.header->clean_shutdown = 1;
+      component::Persist(&(part.header->clean_shutdown), kWordSize);
+    }
+    pmemobj_close(part.pop);
+  }
+  partitions_.clear();
 }
 
 }  // namespace dbgroup::pmem::atomic
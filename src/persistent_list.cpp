@@ -0,0 +1,190 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/persistent_list.hpp"
+
+// C++ standard libraries
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// local sources
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic
+{
+/*##############################################################################
+ * Public constructors
+ *############################################################################*/
+
+PersistentList::PersistentList(  //
+    void *region,
+    const size_t capacity,
+    DescriptorPool &pool)
+    : cursor_{static_cast<uint64_t *>(region)},
+      nodes_{reinterpret_cast<Node *>(cursor_ + 1)},
+      capacity_{capacity},
+      pool_{&pool}
+{
+  static_assert(sizeof(Node) == 3 * kWordSize);
+
+  if (pool.GetCapacity() < kInsertTargetNum) {
+    throw std::invalid_argument{"descriptors must have at least five targets."};
+  }
+}
+
+/*##############################################################################
+ * Public getters
+ *############################################################################*/
+
+auto
+PersistentList::AllocatedNum() const  //
+    -> size_t
+{
+  return PLoad(cursor_, std::memory_order_acquire);
+}
+
+/*##############################################################################
+ * Public utilities
+ *############################################################################*/
+
+auto
+PersistentList::Read(  //
+    const uint64_t key,
+    uint64_t &value) const  //
+    -> bool
+{
+  const auto pos = Search(key);
+  if (pos.cur == nullptr || pos.key != key) return false;
+
+  const auto cur_val = PLoad(&(pos.cur->value), std::memory_order_acquire);
+  if (cur_val == kTombstone) return false;
+  value = cur_val;
+  return true;
+}
+
+auto
+PersistentList::Insert(  //
+    const uint64_t key,
+    const uint64_t value)  //
+    -> bool
+{
+  assert(key <= kMaxValue && value <= kMaxValue);
+
+  auto *desc = pool_->Get();
+  while (true) {
+    const auto pos = Search(key);
+    if (pos.pred_next & kDeletedFlag) continue;  // the predecessor is being deleted
+    if (pos.cur != nullptr && pos.key == key) return false;
+
+    // only reread the cursor if other insertions allocated nodes
+    auto search_again = false;
+    const auto inserted = desc->PMwCASWithRetry(
+        [&](PMwCASDescriptor &d, const PMwCASConflict *prev) {
+          if (prev != nullptr && prev->addr != cursor_) {
+            search_again = true;
+            return false;
+          }
+          const auto cursor = PLoad(cursor_, std::memory_order_acquire);
+          if (cursor >= capacity_) return false;
+
+          // allocate and link a new node at once
+          auto *node = &(nodes_[cursor + 1]);
+          d.Add(cursor_, cursor, cursor + 1);
+          d.Add(&(node->key), uint64_t{0}, key, std::memory_order_relaxed);
+          d.Add(&(node->value), uint64_t{0}, value, std::memory_order_relaxed);
+          d.Add(&(node->next), uint64_t{0}, pos.pred_next, std::memory_order_relaxed);
+          d.Add(&(pos.pred->next), pos.pred_next, (cursor + 1) << 1UL);
+          return true;
+        });
+    if (!search_again) return inserted;
+  }
+}
+
+auto
+PersistentList::Update(  //
+    const uint64_t key,
+    const uint64_t value)  //
+    -> bool
+{
+  assert(value <= kMaxValue);
+
+  const auto pos = Search(key);
+  if (pos.cur == nullptr || pos.key != key) return false;
+
+  // a deletion embeds a descriptor into the value, so PCAS must not be used
+  auto *desc = pool_->Get();
+  while (true) {
+    const auto cur_val = PLoad(&(pos.cur->value), std::memory_order_acquire);
+    if (cur_val == kTombstone) return false;
+    if (desc->PMwCAS(PMwCASEntry{&(pos.cur->value), cur_val, value, std::memory_order_release})) {
+      return true;
+    }
+  }
+}
+
+auto
+PersistentList::Delete(  //
+    const uint64_t key)  //
+    -> bool
+{
+  auto *desc = pool_->Get();
+  while (true) {
+    const auto pos = Search(key);
+    if (pos.pred_next & kDeletedFlag) continue;  // the predecessor is being deleted
+    if (pos.cur == nullptr || pos.key != key) return false;
+
+    const auto next = PLoad(&(pos.cur->next), std::memory_order_acquire);
+    const auto value = PLoad(&(pos.cur->value), std::memory_order_relaxed);
+    if ((next & kDeletedFlag) || value == kTombstone) continue;
+
+    // unlink the node and prevent insertions after it at once
+    desc->Add(&(pos.pred->next), pos.pred_next, next);
+    desc->Add(&(pos.cur->next), next, next | kDeletedFlag, std::memory_order_relaxed);
+    desc->Add(&(pos.cur->value), value, kTombstone, std::memory_order_relaxed);
+    if (desc->PMwCAS()) return true;
+  }
+}
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+auto
+PersistentList::Search(  //
+    const uint64_t key) const  //
+    -> Position
+{
+  Position pos{nodes_, PLoad(&(nodes_->next), std::memory_order_acquire), nullptr, 0};
+  while (true) {
+    pos.cur = GetNode(pos.pred_next);
+    if (pos.cur == nullptr) return pos;
+
+    // deleted nodes are never reused, so they can be traversed safely
+    pos.key = PLoad(&(pos.cur->key), std::memory_order_relaxed);
+    if (pos.key >= key) return pos;
+    pos.pred = pos.cur;
+    pos.pred_next = PLoad(&(pos.cur->next), std::memory_order_acquire);
+  }
+}
+
+}  // namespace dbgroup::pmem::atomic
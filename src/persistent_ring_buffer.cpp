@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/persistent_ring_buffer.hpp"
+
+// C++ standard libraries
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// local sources
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
+#include "pmem/atomic/utility.hpp"
+
+namespace dbgroup::pmem::atomic
+{
+/*##############################################################################
+ * Public constructors
+ *############################################################################*/
+
+PersistentRingBuffer::PersistentRingBuffer(  //
+    void *region,
+    const size_t capacity,
+    DescriptorPool &pool)
+    : head_{static_cast<uint64_t *>(region)},
+      tail_{head_ + kCacheLineSize / kWordSize},
+      slots_{tail_ + kCacheLineSize / kWordSize},
+      capacity_{capacity},
+      pool_{&pool}
+{
+  if (capacity == 0) {
+    throw std::invalid_argument{"the capacity of a ring buffer must not be zero."};
+  }
+}
+
+/*##############################################################################
+ * Public getters
+ *############################################################################*/
+
+auto
+PersistentRingBuffer::Size() const  //
+    -> size_t
+{
+  const auto head = PLoad(head_, std::memory_order_acquire);
+  const auto tail = PLoad(tail_, std::memory_order_acquire);
+  return tail > head ? tail - head : 0;
+}
+
+/*##############################################################################
+ * Public utilities
+ *############################################################################*/
+
+auto
+PersistentRingBuffer::Push(  //
+    const uint64_t value)  //
+    -> bool
+{
+  assert(value <= kMaxValue);
+
+  auto *desc = pool_->Get();
+  while (true) {
+    const auto tail = PLoad(tail_, std::memory_order_acquire);
+    auto *slot = GetSlot(tail);
+    if (PLoad(slot, std::memory_order_acquire) != 0) {
+      // the slot has the value pushed one lap before unless the tail is stale
+      if (PLoad(tail_, std::memory_order_acquire) == tail) return false;
+      continue;
+    }
+
+    desc->Add(tail_, tail, tail + 1);
+    desc->Add(slot, uint64_t{0}, value + 1);
+    if (desc->PMwCAS()) return true;
+  }
+}
+
+auto
+PersistentRingBuffer::Pop(  //
+    uint64_t &value)  //
+    -> bool
+{
+  auto *desc = pool_->Get();
+  while (true) {
+    const auto head = PLoad(head_, std::memory_order_acquire);
+    auto *slot = GetSlot(head);
+    const auto stored = PLoad(slot, std::memory_order_acquire);
+    if (stored == 0) {
+      // the slot is waiting for the next push unless the head is stale
+      if (PLoad(head_, std::memory_order_acquire) == head) return false;
+      continue;
+    }
+
+    desc->Add(head_, head, head + 1);
+    desc->Add(slot, stored, uint64_t{0});
+    if (desc->PMwCAS()) {
+      value = stored - 1;
+      return true;
+    }
+  }
+}
+
+}  // namespace dbgroup::pmem::atomic
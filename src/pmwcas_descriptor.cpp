@@ -18,12 +18,30 @@
 #include "pmem/atomic/pmwcas_descriptor.hpp"
 
 // C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// system libraries
+#if defined(PMEM_ATOMIC_USE_HTM) || defined(PMEM_ATOMIC_USE_SINGLE_LINE_HTM)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 // external system libraries
-#include <libpmem.h>
+#include <libpmemobj.h>
 
 // local sources
+#include "pmem/atomic/component/group_commit.hpp"
+#include "pmem/atomic/component/persist.hpp"
+#include "pmem/atomic/component/stats.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
 #include "pmem/atomic/utility.hpp"
 
 namespace dbgroup::pmem::atomic
@@ -37,8 +55,320 @@ namespace
 /// @brief The size of a PMwCAS header in bytes.
 constexpr size_t kHeaderSize = 2 * kWordSize;
 
+/// @brief An alias of std::memory_order_relaxed.
+constexpr auto kMORelax = std::memory_order_relaxed;
+
+/// @brief The number of bits for representing virtual addresses of descriptors.
+constexpr size_t kDescAddrBits = 48;
+
+/// @brief The number of sequence bits in the alignment bits of descriptors.
+constexpr size_t kLowSeqBits = 8;
+
+/// @brief A mask for extracting the lower bits of sequence numbers.
+constexpr uint64_t kLowSeqMask = (1UL << kLowSeqBits) - 1;
+
+/// @brief A mask for extracting virtual addresses of descriptors.
+constexpr uint64_t kDescAddrMask = ((1UL << kDescAddrBits) - 1) & ~kLowSeqMask;
+
+/// @brief A mask for extracting sequence numbers from descriptor words.
+constexpr uint64_t kWordSeqMask = ~(kDescAddrMask | kIsIntermediate);
+
+#if defined(PMEM_ATOMIC_USE_HTM) || defined(PMEM_ATOMIC_USE_SINGLE_LINE_HTM)
+/// @brief The maximum number of retries of hardware transactions.
+constexpr size_t kHTMRetryNum = 3;
+#endif
+
+#ifdef PMEM_ATOMIC_USE_SINGLE_LINE_HTM
+/// @brief An abort code for indicating a target has an unexpected value.
+constexpr unsigned int kStaleAbort = 0xFF;
+#endif
+
+/*##############################################################################
+ * Local utilities
+ *############################################################################*/
+
+/**
+ * @brief Count the result of a PMwCAS operation.
+ *
+ * @param succeeded A flag for indicating the PMwCAS operation succeeded.
+ * @return The given flag as is.
+ */
+auto
+CountResult(  //
+    const bool succeeded)  //
+    -> bool
+{
+  component::CountEvent(succeeded ? StatEvent::kPMwCAS : StatEvent::kPMwCASFailure);
+  return succeeded;
+}
+
+/**
+ * @brief Record a target that caused a PMwCAS operation to fail.
+ *
+ * @param conflict An optional output of the conflicting target.
+ * @param target The conflicting target.
+ * @param index The position of the target in a descriptor chain.
+ */
+void
+RecordConflict(  //
+    PMwCASConflict *conflict,
+    const component::PMwCASTarget &target,
+    const size_t index)
+{
+  if (conflict == nullptr) return;
+  *conflict = PMwCASConflict{target.GetAddr(), index, target.Load()};
+}
+
+/**
+ * @brief Record that helping threads decided the failure of a PMwCAS operation.
+ *
+ * @param conflict An optional output of the conflicting target.
+ */
+void
+RecordHelpedFailure(  //
+    PMwCASConflict *conflict)
+{
+  if (conflict == nullptr) return;
+  *conflict = PMwCASConflict{};
+}
+
+#if defined(PMEM_ATOMIC_USE_HTM) || defined(PMEM_ATOMIC_USE_SINGLE_LINE_HTM)
+/**
+ * @retval true if the CPU supports Intel RTM.
+ * @retval false otherwise.
+ */
+auto
+HasRTM()  //
+    -> bool
+{
+  static const bool has_rtm = [] {
+    unsigned int eax{};
+    unsigned int ebx{};
+    unsigned int ecx{};
+    unsigned int edx{};
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 && (ebx & bit_RTM) != 0;
+  }();
+  return has_rtm;
+}
+#endif
+
+#ifdef PMEM_ATOMIC_USE_HTM
+/**
+ * @brief Embed a descriptor into all the given targets in one hardware
+ * transaction.
+ *
+ * @param targets PMwCAS targets.
+ * @param num The number of targets.
+ * @param desc_word A descriptor word to be embedded.
+ * @retval true if the descriptor is embedded into all the targets.
+ * @retval false if transactions aborted or any target had an unexpected value.
+ */
+auto
+EmbedDescriptorsInHTM(  //
+    component::PMwCASTarget *targets,
+    const size_t num,
+    const uint64_t desc_word)  //
+    -> bool
+{
+  if (!HasRTM()) return false;
+
+  for (size_t i = 0; i < kHTMRetryNum; ++i) {
+    const auto status = _xbegin();
+    if (status == _XBEGIN_STARTED) {
+      for (size_t j = 0; j < num; ++j) {
+        if (!targets[j].EmbedDescriptorInHTM(desc_word)) _xabort(0);
+      }
+      _xend();
+      return true;
+    }
+    if ((status & _XABORT_RETRY) == 0) break;
+  }
+  return false;
+}
+#endif
+
+/**
+ * @brief Flush the cache lines of given targets.
+ *
+ * Cache lines shared by multiple targets are flushed only once, and lines are
+ * flushed in ascending address order. This function does not drain flushed
+ * lines.
+ *
+ * @param targets PMwCAS targets to be flushed.
+ * @param num The number of targets to be flushed.
+ */
+void
+FlushTargets(  //
+    const component::PMwCASTarget *targets,
+    const size_t num)
+{
+  constexpr auto kLineMask = ~static_cast<uintptr_t>(kCacheLineSize - 1);
+
+  // collect the cache lines of targets and remove duplicates
+  uintptr_t lines[kPMwCASCapacity];
+  for (size_t i = 0; i < num; ++i) {
+    lines[i] = reinterpret_cast<uintptr_t>(targets[i].GetAddr()) & kLineMask;
+  }
+  std::sort(lines, lines + num);
+  const auto *end = std::unique(lines, lines + num);
+
+  // flush each line only once
+  for (const auto *line = lines; line < end; ++line) {
+    component::Flush(reinterpret_cast<void *>(*line), kCacheLineSize);
+  }
+}
+
+/**
+ * @brief Embed a descriptor into a given target.
+ *
+ * @param target A PMwCAS target.
+ * @param desc_word A descriptor word to be embedded.
+ * @retval true if the descriptor is embedded.
+ * @retval false if the target has an unexpected value.
+ */
+auto
+EmbedTarget(  //
+    component::PMwCASTarget &target,
+    const uint64_t desc_word)  //
+    -> bool
+{
+  if (target.EmbedDescriptor(desc_word)) return true;
+
+  const auto word = target.Load();
+  if ((word & kPMwCASFlag) == 0) return false;
+  if (DescriptorPool::RecoverEmbedded(word)) {
+    // the descriptor has been left since restart, so recover it and retry embedding
+    return target.EmbedDescriptor(desc_word);
+  }
+  if constexpr (kHelpPMwCAS) {
+    // complete a conflicting PMwCAS operation and retry embedding
+    PMwCASDescriptor::HelpPMwCAS(word);
+    return target.EmbedDescriptor(desc_word);
+  }
+  return false;
+}
+
+/**
+ * @brief Embed a descriptor into a given target on behalf of its owner.
+ *
+ * @param target A PMwCAS target.
+ * @param desc_word A descriptor word to be embedded.
+ * @retval kSucceeded if the target has the descriptor.
+ * @retval kFailed if the target has an unexpected value.
+ * @retval kUndecided if another operation in progress blocks the target.
+ */
+auto
+HelpEmbedding(  //
+    component::PMwCASTarget &target,
+    const uint64_t desc_word)  //
+    -> component::DescStatus
+{
+  if (target.EmbedDescriptor(desc_word)) return component::DescStatus::kSucceeded;
+
+  const auto word = target.Load();
+  if (word == desc_word) return component::DescStatus::kSucceeded;
+  if (word & kIsIntermediate) return component::DescStatus::kUndecided;
+  return component::DescStatus::kFailed;
+}
+
+#ifdef PMEM_ATOMIC_USE_SINGLE_LINE_HTM
+/**
+ * @param targets PMwCAS targets.
+ * @param num The number of targets.
+ * @retval true if all the targets are in one cache line.
+ * @retval false otherwise.
+ */
+auto
+IsOnOneLine(  //
+    const component::PMwCASTarget *targets,
+    const size_t num)  //
+    -> bool
+{
+  constexpr auto kLineMask = ~static_cast<uintptr_t>(kCacheLineSize - 1);
+
+  if (num == 0) return false;
+  const auto line = reinterpret_cast<uintptr_t>(targets[0].GetAddr()) & kLineMask;
+  for (size_t i = 1; i < num; ++i) {
+    if ((reinterpret_cast<uintptr_t>(targets[i].GetAddr()) & kLineMask) != line) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Write the desired values of given targets in one hardware transaction.
+ *
+ * @param targets PMwCAS targets in one cache line.
+ * @param num The number of targets.
+ * @param dirty A flag for setting dirty flags to the desired values.
+ * @retval kSucceeded if all the targets are updated.
+ * @retval kFailed if any target has an unexpected value.
+ * @retval kUndecided if transactions aborted for other reasons.
+ */
+auto
+UpdateOneLineInHTM(  //
+    component::PMwCASTarget *targets,
+    const size_t num,
+    const bool dirty)  //
+    -> component::DescStatus
+{
+  if (!HasRTM()) return component::DescStatus::kUndecided;
+
+  for (size_t i = 0; i < kHTMRetryNum; ++i) {
+    const auto status = _xbegin();
+    if (status == _XBEGIN_STARTED) {
+      for (size_t j = 0; j < num; ++j) {
+        if (targets[j].UpdateInHTM(dirty)) continue;
+        // intermediate states may be resolved, so retry with the usual protocol
+        if (targets[j].Load() & kIsIntermediate) _xabort(0);
+        _xabort(kStaleAbort);
+      }
+      _xend();
+      return component::DescStatus::kSucceeded;
+    }
+    if ((status & _XABORT_EXPLICIT) && _XABORT_CODE(status) == kStaleAbort) {
+      return component::DescStatus::kFailed;
+    }
+    if ((status & _XABORT_RETRY) == 0) break;
+  }
+  return component::DescStatus::kUndecided;
+}
+
+/**
+ * @brief Record the first target that has an unexpected value.
+ *
+ * @param conflict An optional output of the conflicting target.
+ * @param targets PMwCAS targets.
+ * @param num The number of targets.
+ */
+void
+FindConflict(  //
+    PMwCASConflict *conflict,
+    const component::PMwCASTarget *targets,
+    const size_t num)
+{
+  if (conflict == nullptr) return;
+  for (size_t i = 0; i < num; ++i) {
+    if (targets[i].Load() == targets[i].GetValue(false)) continue;
+    RecordConflict(conflict, targets[i], i);
+    return;
+  }
+  RecordHelpedFailure(conflict);  // the target has been reverted concurrently
+}
+#endif
+
 }  // namespace
 
+/*##############################################################################
+ * Public getters
+ *############################################################################*/
+
+auto
+PMwCASDescriptor::GetDescWord() const  //
+    -> uint64_t
+{
+  return desc_addr_ | ToWordSeq(state_.load(std::memory_order_relaxed));
+}
+
 /*##############################################################################
  * Public utilities
  *############################################################################*/
@@ -47,70 +377,603 @@ auto
 PMwCASDescriptor::PMwCAS()  //
     -> bool
 {
-  const size_t desc_size = kHeaderSize + kWordSize + sizeof(PMwCASTarget) * target_count_;
+  return RunPMwCAS(nullptr);
+}
+
+auto
+PMwCASDescriptor::PMwCAS(  //
+    PMwCASConflict &conflict)  //
+    -> bool
+{
+  return RunPMwCAS(&conflict);
+}
+
+auto
+PMwCASDescriptor::StartPMwCAS(  //
+    PMwCASConflict *conflict)  //
+    -> bool
+{
+  if (IsPending()) FinishPMwCAS();
+  if (next_addr_ != 0) return StartChainedPMwCAS(conflict);
+  return DispatchPMwCAS(Size(), conflict, std::make_index_sequence<kPMwCASCapacity + 1>{});
+}
+
+void
+PMwCASDescriptor::FinishPMwCAS()
+{
+  const auto state = state_.load(kMORelax);
+  if ((state & kStatusMask) == DescStatus::kCompleted) return;
+
+  if constexpr (kHelpPMwCAS) {
+    // helping threads may update the targets until they leave this descriptor
+    state_.fetch_or(kFinishFlag, kMORelax);
+    while (state_.load(std::memory_order_acquire) & kHelperMask) {
+      std::this_thread::yield();
+    }
+  }
+
+  // the log must be kept until all the targets are persisted
+  if (persistent_) {
+    component::Drain();
+  }
+
+  // overflow descriptors must be reset before the head for recovery
+  if (next_addr_ != 0) {
+    ReleaseChain();
+    if (persistent_) {
+      component::Drain();
+    }
+  }
+
+  // reset the descriptor and its targets after other threads can detect it
+  state_.store((state & kSeqMask) | DescStatus::kCompleted, kMORelax);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void
+PMwCASDescriptor::Initialize(  //
+    const size_t capacity,
+    const bool persistent)
+{
+  static_assert(offsetof(PMwCASDescriptor, targets_) == 6 * kWordSize);
+  static_assert(sizeof(PMwCASTarget) == 3 * kWordSize);
+  static_assert(kPMwCASCapacity <= (kCountMask >> kCountShift));
+  static_assert(alignof(PMwCASDescriptor) > kLowSeqMask);
+  assert(capacity > 0 && capacity <= kPMwCASCapacity);
+
+  // descriptor words embed sequence numbers into the alignment bits
+  const auto addr = reinterpret_cast<uintptr_t>(this);
+  if ((addr & kLowSeqMask) != 0) {
+    throw std::invalid_argument{"PMwCAS descriptors must be aligned to PMEM lines."};
+  }
+
+  const auto state = state_.load(std::memory_order_acquire);
+  const auto status = state & kStatusMask;
+  const auto count = (state & kCountMask) >> kCountShift;
+
+  // an overflow descriptor is recovered and reset by the head of its chain
+  capacity_ = capacity;
+  persistent_ = persistent;
+  if (persistent && (state & kChainFlag)) return;
+
+  // roll forward or roll back PMwCAS if needed
+  if (persistent && status != DescStatus::kCompleted && count <= capacity) {
+    const auto succeeded = (status == DescStatus::kSucceeded);
+    const auto desc_word = desc_addr_ | ToWordSeq(state);
+    RecoverTargets(succeeded, desc_word, count);
+
+    // follow the chain by the offsets from the previous address of this head
+    const auto base = reinterpret_cast<uintptr_t>(this) - (desc_addr_ & kDescAddrMask);
+    for (auto next = next_addr_; next != 0;) {
+      auto *desc = reinterpret_cast<PMwCASDescriptor *>(next + base);
+      const auto desc_state = desc->state_.load(std::memory_order_acquire);
+      const auto desc_count = (desc_state & kCountMask) >> kCountShift;
+      if ((desc_state & kChainFlag) == 0 || desc->desc_addr_ != desc_word) break;
+      if (desc_count > capacity) break;
+
+      desc->RecoverTargets(succeeded, desc_word, desc_count);
+      next = desc->next_addr_;
+      desc->next_addr_ = 0;
+      desc->state_.store((desc_state & kSeqMask) | DescStatus::kCompleted, kMORelax);
+      component::Flush(desc, offsetof(PMwCASDescriptor, targets_));
+    }
+  }
+
+  // use the virtual address of this descriptor in the current process
+  assert((addr & ~kDescAddrMask) == 0);
+  desc_addr_ = addr | kPMwCASFlag;
+  next_addr_ = 0;
+
+  // change status and persist a descriptor
+  state_.store((state & kSeqMask) | DescStatus::kCompleted, kMORelax);
+  if (persistent) {
+    component::Flush(this, offsetof(PMwCASDescriptor, targets_));
+  }
+}
+
+auto
+PMwCASDescriptor::HelpPMwCAS(  //
+    const uint64_t desc_word)  //
+    -> bool
+{
+  auto *desc = reinterpret_cast<PMwCASDescriptor *>(desc_word & kDescAddrMask);
+  const auto seq = ToStateSeq(desc_word);
+  const auto persistent = desc->persistent_;
+
+  // prevent the owner from finishing the PMwCAS operation while helping it
+  auto state = desc->state_.load(kMORelax);
+  do {
+    if ((state & kSeqMask) != seq || (state & kFinishFlag)
+        || (state & kStatusMask) == DescStatus::kCompleted) {
+      return true;
+    }
+  } while (!desc->state_.compare_exchange_weak(state, state + kHelperUnit,
+                                               std::memory_order_acquire, kMORelax));
+
+  auto status = static_cast<DescStatus>(state & kStatusMask);
+  if (status == DescStatus::kUndecided) {
+    // finish embedding the remaining targets instead of rolling back the operation
+    auto decision = DescStatus::kSucceeded;
+    const auto visited = VisitTargets(desc, desc_word, [&](PMwCASTarget *targets, size_t count) {
+      for (size_t i = 0; i < count && decision == DescStatus::kSucceeded; ++i) {
+        decision = HelpEmbedding(targets[i], desc_word);
+      }
+      if (decision == DescStatus::kSucceeded && persistent) {
+        FlushTargets(targets, count);
+      }
+    });
+    if (visited == DescStatus::kCompleted) {
+      decision = DescStatus::kUndecided;  // overflow descriptors are not visible yet
+    } else if (decision == DescStatus::kSucceeded && persistent) {
+      component::Drain();
+    }
+    if (decision != DescStatus::kUndecided) {
+      status = desc->Decide(decision);
+    }
+  }
+
+  // if the operation is still undecided, its owner updates the targets embedded here
+  state = desc->state_.load(kMORelax);
+  while (status == DescStatus::kUndecided) {
+    status = static_cast<DescStatus>(state & kStatusMask);
+    if (status != DescStatus::kUndecided) break;
+    if (desc->state_.compare_exchange_weak(state, state - kHelperUnit,
+                                           std::memory_order_release, kMORelax)) {
+      return false;
+    }
+  }
+
+  // the decision must be durable before updating the targets
+  const auto succeeded = status == DescStatus::kSucceeded;
+  if (succeeded && persistent) {
+    component::Persist(&(desc->state_), kWordSize);
+  }
+  VisitTargets(desc, desc_word, [&](PMwCASTarget *targets, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      if (succeeded) {
+        targets[i].Redo(desc_word);
+      } else {
+        targets[i].Undo(desc_word);
+      }
+    }
+    if (persistent) {
+      FlushTargets(targets, count);
+    }
+  });
+  if (persistent) {
+    component::Drain();
+  }
+  desc->state_.fetch_sub(kHelperUnit, std::memory_order_release);
+  return true;
+}
+
+auto
+PMwCASDescriptor::ReadTarget(  //
+    const uint64_t desc_word,
+    const void *addr,
+    uint64_t &val)  //
+    -> bool
+{
+  auto *desc = reinterpret_cast<PMwCASDescriptor *>(desc_word & kDescAddrMask);
+
+  // search the target in the copied targets of the PMwCAS operation
+  auto found = false;
+  PMwCASTarget target{};
+  const auto status =
+      VisitTargets(desc, desc_word, [&](const PMwCASTarget *targets, const size_t count) {
+        for (size_t i = 0; i < count && !found; ++i) {
+          found = targets[i].GetAddr() == addr;
+          if (found) target = targets[i];
+        }
+      });
+  if (status == DescStatus::kCompleted || !found) return false;
+
+  val = target.GetValue(status == DescStatus::kSucceeded);
+  return true;
+}
+
+void
+PMwCASDescriptor::Extend(  //
+    PMwCASDescriptor *desc)
+{
+  if (IsPending()) FinishPMwCAS();
+  assert(desc != this && desc->Size() == 0 && !desc->IsPending());
+  assert(desc->next_addr_ == 0 && desc->persistent_ == persistent_);
+
+  auto *tail = this;
+  while (tail->next_addr_ != 0) {
+    tail = tail->GetNext();
+  }
+  tail->next_addr_ = reinterpret_cast<uintptr_t>(desc);
+}
+
+/*##############################################################################
+ * Internal utilities
+ *############################################################################*/
+
+auto
+PMwCASDescriptor::RunPMwCAS(  //
+    PMwCASConflict *conflict)  //
+    -> bool
+{
+  const auto begin = component::StartTimer();
+  const auto succeeded = StartPMwCAS(conflict);
+  if (component::tls_group_commit.IsActive()) {
+    component::tls_group_commit.AddDescriptor(this);
+  } else {
+    FinishPMwCAS();
+  }
+  component::RecordLatency(component::LatencyType::kPMwCAS, begin);
+  return succeeded;
+}
 
-  // initialize and persist PMwCAS status
-  status_ = DescStatus::kFailed;
-  pmem_persist(this, desc_size);
+template <size_t kNum>
+auto
+PMwCASDescriptor::StartPMwCASWith(  //
+    PMwCASConflict *conflict)  //
+    -> bool
+{
+  // fail without persisting anything if an expected value is already stale
+  constexpr size_t count = kNum;
+  for (size_t i = 0; i < count; ++i) {
+    if (!targets_[i].MayHaveExpectedValue()) {
+      RecordConflict(conflict, targets_[i], i);
+      SetSize(0);
+      return CountResult(false);
+    }
+  }
+
+#ifdef PMEM_ATOMIC_USE_SINGLE_LINE_HTM
+  // a transaction makes the targets visible at once, but they are written back
+  // without a log, so this path is crash-atomic only if caches are persistent
+  if (IsOnOneLine(targets_, count)) {
+    const auto dirty = kUseDirtyFlag && persistent_;
+    const auto status = UpdateOneLineInHTM(targets_, count, dirty);
+    if (status != DescStatus::kUndecided) {
+      if (status == DescStatus::kSucceeded && persistent_) {
+        const auto defer = component::tls_group_commit.IsActive();
+        FlushTargets(targets_, count);
+        if (!defer) {
+          component::Drain();
+        }
+        for (size_t i = 0; i < count && dirty; ++i) {
+          targets_[i].ClearDirtyFlag(defer);
+        }
+      } else if (status == DescStatus::kFailed) {
+        FindConflict(conflict, targets_, count);
+      }
+      SetSize(0);
+      return CountResult(status == DescStatus::kSucceeded);
+    }
+  }
+#endif
+
+  constexpr size_t kTargetOffset = offsetof(PMwCASDescriptor, targets_);
+  const size_t desc_size = kTargetOffset + sizeof(PMwCASTarget) * count;
+
+  // initialize and persist PMwCAS status with a new sequence number
+  const auto seq = (state_.load(kMORelax) + kSeqUnit) & kSeqMask;
+  desc_addr_ = reinterpret_cast<uintptr_t>(this) | kPMwCASFlag;  // may be remapped
+  const auto desc_word = desc_addr_ | ToWordSeq(seq);
+  state_.store(seq | (count << kCountShift) | DescStatus::kUndecided, std::memory_order_release);
+  if (persistent_) {
+    component::Persist(this, desc_size);
+  }
 
   // linearize PMwCAS operations by embedding a descriptor
   size_t embedded_count = 0;
-  for (size_t i = 0;                                                  //
-       i < target_count_ && targets_[i].EmbedDescriptor(desc_addr_);  //
-       ++i, ++embedded_count) {
+#ifdef PMEM_ATOMIC_USE_HTM
+  if (EmbedDescriptorsInHTM(targets_, count, desc_word)) {
+    embedded_count = count;
+  }
+#endif
+  for (; embedded_count < count; ++embedded_count) {
+    if (!EmbedTarget(targets_[embedded_count], desc_word)) break;
+  }
+
+  // decide the status of this PMwCAS operation
+  auto status = DescStatus::kFailed;
+  if (embedded_count == count) {
+    // persist the embedded descriptors for fault-tolerance
+    if (persistent_) {
+      FlushTargets(targets_, count);
+    }
+    status = Decide(DescStatus::kSucceeded);
+    if (status == DescStatus::kFailed) {
+      RecordHelpedFailure(conflict);
+    }
+  } else {
+    // helping threads may have embedded the remaining targets and succeeded
+    status = Decide(DescStatus::kFailed);
+    if (status == DescStatus::kFailed) {
+      RecordConflict(conflict, targets_[embedded_count], embedded_count);
+    }
   }
 
   // complete PMwCAS
-  if (embedded_count < target_count_) {
-    // PMwCAS failed, so revert changes
-    for (size_t i = 0; i < embedded_count; ++i) {
-      targets_[i].Undo();
+  if (status == DescStatus::kSucceeded) {
+    if (persistent_) {
+      component::Flush(this, kHeaderSize);
+      component::Drain();
     }
-    pmem_drain();
 
-    // reset the descriptor
-    status_ = DescStatus::kCompleted;
-    target_count_ = 0;
-    return false;
+    // update the target address with the desired values
+    for (size_t i = 0; i < count; ++i) {
+      targets_[i].Redo(desc_word);
+    }
+    if (persistent_) {
+      FlushTargets(targets_, count);
+    }
+  } else {
+    // PMwCAS failed, so revert changes including those by helping threads
+    const auto undo_count = kHelpPMwCAS ? count : embedded_count;
+    for (size_t i = 0; i < undo_count; ++i) {
+      targets_[i].Undo(desc_word);
+    }
+    if (persistent_) {
+      FlushTargets(targets_, undo_count);
+    }
   }
+  return CountResult(status == DescStatus::kSucceeded);
+}
+
+template <size_t... kNums>
+auto
+PMwCASDescriptor::DispatchPMwCAS(  //
+    const size_t count,
+    PMwCASConflict *conflict,
+    std::index_sequence<kNums...>)  //
+    -> bool
+{
+  auto succeeded = false;
+  ((count == kNums && (succeeded = StartPMwCASWith<kNums>(conflict), true)) || ...);
+  return succeeded;
+}
+
+auto
+PMwCASDescriptor::StartChainedPMwCAS(  //
+    PMwCASConflict *conflict)  //
+    -> bool
+{
+  constexpr size_t kTargetOffset = offsetof(PMwCASDescriptor, targets_);
 
-  // PMwCAS succeeded, so persist the embedded descriptors for fault-tolerance
-  for (size_t i = 0; i < target_count_; ++i) {
-    targets_[i].Flush();
+  // fail without persisting anything if an expected value is already stale
+  size_t index = 0;
+  for (auto *desc = this; desc != nullptr; desc = desc->GetNext()) {
+    const auto count = desc->Size();
+    for (size_t i = 0; i < count; ++i, ++index) {
+      if (!desc->targets_[i].MayHaveExpectedValue()) {
+        RecordConflict(conflict, desc->targets_[i], index);
+        ReleaseChain();
+        SetSize(0);
+        return CountResult(false);
+      }
+    }
   }
-  status_ = DescStatus::kSucceeded;
-  pmem_flush(this, kHeaderSize);
-  pmem_drain();
 
-  // update the target address with the desired values
-  for (size_t i = 0; i < target_count_; ++i) {
-    targets_[i].Redo();
+  // the head must be persisted first so that recovery can find overflow ones
+  const auto count = Size();
+  const auto seq = (state_.load(kMORelax) + kSeqUnit) & kSeqMask;
+  desc_addr_ = reinterpret_cast<uintptr_t>(this) | kPMwCASFlag;  // may be remapped
+  const auto desc_word = desc_addr_ | ToWordSeq(seq);
+  state_.store(seq | (count << kCountShift) | DescStatus::kUndecided, std::memory_order_release);
+  if (persistent_) {
+    component::Persist(this, kTargetOffset + sizeof(PMwCASTarget) * count);
+  }
+  for (auto *desc = GetNext(); desc != nullptr; desc = desc->GetNext()) {
+    const auto state = desc->state_.load(kMORelax);
+    desc->desc_addr_ = desc_word;
+    desc->state_.store((state & ~kStatusMask) | kChainFlag | DescStatus::kCompleted,
+                       std::memory_order_release);
+    if (persistent_) {
+      component::Flush(desc, kTargetOffset + sizeof(PMwCASTarget) * desc->Size());
+    }
+  }
+  if (persistent_) {
+    component::Drain();
   }
-  pmem_drain();
 
-  // reset the descriptor
-  status_ = DescStatus::kCompleted;
-  target_count_ = 0;
-  return true;
+  // linearize PMwCAS operations by embedding the head into all the targets
+  size_t embedded_count = 0;
+  const PMwCASTarget *stale = nullptr;
+  for (auto *desc = this; desc != nullptr && stale == nullptr; desc = desc->GetNext()) {
+    const auto n = desc->Size();
+    for (size_t i = 0; i < n; ++i, ++embedded_count) {
+      if (!EmbedTarget(desc->targets_[i], desc_word)) {
+        stale = &(desc->targets_[i]);
+        break;
+      }
+    }
+  }
+
+  // decide the status of this PMwCAS operation
+  auto status = DescStatus::kFailed;
+  if (stale == nullptr) {
+    // persist the embedded descriptors for fault-tolerance
+    for (auto *desc = this; desc != nullptr && persistent_; desc = desc->GetNext()) {
+      FlushTargets(desc->targets_, desc->Size());
+    }
+    status = Decide(DescStatus::kSucceeded);
+    if (status == DescStatus::kFailed) {
+      RecordHelpedFailure(conflict);
+    }
+  } else {
+    // helping threads may have embedded the remaining targets and succeeded
+    status = Decide(DescStatus::kFailed);
+    if (status == DescStatus::kFailed) {
+      RecordConflict(conflict, *stale, embedded_count);
+    }
+  }
+  if (status == DescStatus::kSucceeded && persistent_) {
+    component::Flush(this, kHeaderSize);
+    component::Drain();
+  }
+
+  // complete PMwCAS by updating or reverting the embedded targets
+  if (kHelpPMwCAS || status == DescStatus::kSucceeded) {
+    embedded_count = std::numeric_limits<size_t>::max();  // including those by helping threads
+  }
+  for (auto *desc = this; desc != nullptr && embedded_count > 0; desc = desc->GetNext()) {
+    const auto n = std::min(desc->Size(), embedded_count);
+    for (size_t i = 0; i < n; ++i) {
+      if (status == DescStatus::kSucceeded) {
+        desc->targets_[i].Redo(desc_word);
+      } else {
+        desc->targets_[i].Undo(desc_word);
+      }
+    }
+    if (persistent_) {
+      FlushTargets(desc->targets_, n);
+    }
+    embedded_count -= n;
+  }
+  return CountResult(status == DescStatus::kSucceeded);
+}
+
+void
+PMwCASDescriptor::ReleaseChain()
+{
+  for (auto *desc = GetNext(); desc != nullptr;) {
+    auto *next = desc->GetNext();
+    desc->next_addr_ = 0;
+    desc->state_.store((desc->state_.load(kMORelax) & kSeqMask) | DescStatus::kCompleted, kMORelax);
+    if (persistent_) {
+      component::Flush(desc, offsetof(PMwCASDescriptor, targets_));
+    }
+    desc = next;
+  }
+  next_addr_ = 0;
 }
 
 void
-PMwCASDescriptor::Initialize()
+PMwCASDescriptor::RecoverTargets(  //
+    const bool succeeded,
+    const uint64_t desc_word,
+    const size_t count)
 {
-  desc_addr_ = pmemobj_oid(this).off | kPMwCASFlag;
+  for (size_t i = 0; i < count; ++i) {
+    // the pool may be mapped to another address, so translate the target
+    const auto off = reinterpret_cast<uint64_t>(targets_[i].GetAddr()) - pool_addr_;
+    auto *addr = pmemobj_direct(PMEMoid{pool_uuid_lo_, off});
+    if (addr == nullptr) continue;
+    targets_[i].Recover(succeeded, desc_word, addr);
+  }
+}
 
-  // roll forward or roll back PMwCAS if needed
-  if (status_ != DescStatus::kCompleted) {
-    const auto succeeded = (status_ == DescStatus::kSucceeded);
-    for (size_t i = 0; i < target_count_; ++i) {
-      targets_[i].Recover(succeeded, desc_addr_);
+template <class Func>
+auto
+PMwCASDescriptor::VisitTargets(  //
+    PMwCASDescriptor *desc,
+    const uint64_t desc_word,
+    Func &&func)  //
+    -> DescStatus
+{
+  const auto seq = ToStateSeq(desc_word);
+  auto status = DescStatus::kCompleted;
+  PMwCASTarget targets[kPMwCASCapacity];
+  for (auto *cur = desc; cur != nullptr;) {
+    // copy the targets of the PMwCAS operation
+    const auto cur_state = cur->state_.load(std::memory_order_acquire);
+    if (cur == desc) {
+      if ((cur_state & kSeqMask) != seq) return DescStatus::kCompleted;
+    } else if ((cur_state & kChainFlag) == 0 || cur->desc_addr_ != desc_word) {
+      return DescStatus::kCompleted;
     }
+    const auto count = (cur_state & kCountMask) >> kCountShift;
+    if (count > cur->capacity_) return DescStatus::kCompleted;
+    for (size_t i = 0; i < count; ++i) {
+      targets[i] = cur->targets_[i];
+    }
+    auto *next = cur->GetNext();
+
+    // check the owner has not reused the descriptors during copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto state = desc->state_.load(kMORelax);
+    if ((state & kSeqMask) != seq) return DescStatus::kCompleted;
+    status = static_cast<DescStatus>(state & kStatusMask);
+    if (status == DescStatus::kCompleted) return status;
+
+    func(targets, count);
+    cur = next;
   }
+  return status;
+}
 
-  // change status and persist a descriptor
-  status_ = DescStatus::kCompleted;
-  target_count_ = 0;
-  pmem_flush(this, kHeaderSize + kWordSize);
+auto
+PMwCASDescriptor::Decide(  //
+    const DescStatus status)  //
+    -> DescStatus
+{
+  auto state = state_.load(kMORelax);
+  if constexpr (kHelpPMwCAS) {
+    // synchronize with helping threads to update the targets embedded by them
+    while ((state & kStatusMask) == DescStatus::kUndecided) {
+      const auto desired = (state & ~kStatusMask) | status;
+      if (state_.compare_exchange_weak(state, desired, std::memory_order_acq_rel, kMORelax)) {
+        return status;
+      }
+    }
+    return static_cast<DescStatus>(state & kStatusMask);
+  } else {
+    state_.store((state & ~kStatusMask) | status, kMORelax);
+    return status;
+  }
+}
+
+auto
+PMwCASDescriptor::ToWordSeq(  //
+    const uint64_t state)     //
+    -> uint64_t
+{
+  const auto seq = (state & kSeqMask) >> kSeqShift;
+  return (seq & kLowSeqMask) | ((seq >> kLowSeqBits) << kDescAddrBits);
+}
+
+auto
+PMwCASDescriptor::ToStateSeq(  //
+    const uint64_t desc_word)  //
+    -> uint64_t
+{
+  const auto high = (desc_word & kWordSeqMask) >> kDescAddrBits;
+  return ((desc_word & kLowSeqMask) | (high << kLowSeqBits)) << kSeqShift;
+}
+
+void
+PMwCASDescriptor::SetTargetPool(  //
+    const void *addr)
+{
+  const auto oid = pmemobj_oid(addr);
+  pool_uuid_lo_ = oid.pool_uuid_lo;
+  pool_addr_ = reinterpret_cast<uint64_t>(addr) - oid.off;
+}
+
+void
+PMwCASDescriptor::CheckTargetPool(  //
+    const void *addr) const
+{
+  if (pmemobj_oid(addr).pool_uuid_lo != pool_uuid_lo_) {
+    throw std::invalid_argument{"PMwCAS targets must be in the same pmemobj pool."};
+  }
 }
 
 }  // namespace dbgroup::pmem::atomic
@@ -52,6 +52,17 @@ class PmemAtomicFixture : public ::testing::Test
 
   using Target = uint64_t;
 
+  /**
+   * @brief A pair of a pointer and its version for double-width PCAS.
+   *
+   */
+  struct alignas(kWideWordSize) VersionedPtr {
+    uint64_t *ptr;
+
+    /// @note The top bit is reserved as a dirty flag.
+    uint64_t version;
+  };
+
   /*############################################################################
    * Constants
    *##########################################################################*/
@@ -81,10 +92,17 @@ class PmemAtomicFixture : public ::testing::Test
     }
 
     // initialize target fields
-    auto &&root = pmemobj_root(pop_, kWordSize);
+    auto &&root = pmemobj_root(pop_, 4 * kWordSize);
     target_ = reinterpret_cast<Target *>(pmemobj_direct(root));
     *target_ = 0UL;
     pmem_persist(target_, kWordSize);
+
+    // align a double-width word to 16 bytes
+    auto addr = reinterpret_cast<uintptr_t>(target_) + kWordSize;
+    addr = (addr + kWideWordSize - 1) & ~(kWideWordSize - 1);
+    wide_target_ = reinterpret_cast<VersionedPtr *>(addr);
+    *wide_target_ = VersionedPtr{target_, 0};
+    pmem_persist(wide_target_, kWideWordSize);
   }
 
   void
@@ -126,6 +144,87 @@ class PmemAtomicFixture : public ::testing::Test
     EXPECT_EQ(kExecNum * thread_num, sum);
   }
 
+  void
+  VerifyWidePCAS(  //
+      const size_t thread_num)
+  {
+    // run a function over multi-threads
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back(&PmemAtomicFixture::WidePCASRandomly, this);
+    }
+
+    {  // wait for all workers to finish initialization
+      while (ready_num_ < thread_num) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+      std::lock_guard x_guard{mtx_};
+      test_ready_ = true;
+    }
+    cond_.notify_all();
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    // check the total number of modifications and the dirty flag
+    EXPECT_EQ(wide_target_->ptr, target_);
+    EXPECT_EQ(kExecNum * thread_num, wide_target_->version);
+  }
+
+  void
+  VerifyPFetchAdd(  //
+      const size_t thread_num)
+  {
+    // run a function over multi-threads
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back(&PmemAtomicFixture::PFetchAddRandomly, this);
+    }
+
+    {  // wait for all workers to finish initialization
+      while (ready_num_ < thread_num) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+      std::lock_guard x_guard{mtx_};
+      test_ready_ = true;
+    }
+    cond_.notify_all();
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    // check the total number of modifications
+    EXPECT_EQ(kExecNum * thread_num, *target_);
+  }
+
+  void
+  VerifyPExchange()
+  {
+    constexpr uint64_t kNewVal = 0xABCDUL;
+
+    EXPECT_EQ(PExchange(target_, kNewVal), 0UL);
+    EXPECT_EQ(PExchange(target_, 1UL), kNewVal);
+    EXPECT_EQ(*target_, 1UL);
+
+    // pointers can be also swapped
+    auto **ptr_addr = reinterpret_cast<uint64_t **>(target_);
+    *target_ = 0UL;
+    EXPECT_EQ(PExchange(ptr_addr, target_), nullptr);
+    EXPECT_EQ(PLoad(ptr_addr), target_);
+  }
+
+  void
+  VerifyPFetchOrAnd()
+  {
+    constexpr uint64_t kLowBits = 0b0101UL;
+    constexpr uint64_t kHighBits = 0b1010UL;
+
+    EXPECT_EQ(PFetchOr(target_, kLowBits), 0UL);
+    EXPECT_EQ(PFetchOr(target_, kHighBits), kLowBits);
+    EXPECT_EQ(PFetchAnd(target_, kHighBits), kLowBits | kHighBits);
+    EXPECT_EQ(PLoad(target_), kHighBits);
+  }
+
  private:
   /*############################################################################
    * Internal utility functions
@@ -148,6 +247,37 @@ class PmemAtomicFixture : public ::testing::Test
     }
   }
 
+  void
+  WidePCASRandomly()
+  {
+    {  // wait for a main thread to release a lock
+      std::unique_lock lock{mtx_};
+      ++ready_num_;
+      cond_.wait(lock, [this] { return test_ready_; });
+    }
+
+    for (size_t i = 0; i < kExecNum; ++i) {
+      auto cur_val = PLoad(wide_target_);
+      while (!PCAS(wide_target_, cur_val, VersionedPtr{cur_val.ptr, cur_val.version + 1})) {
+        // continue until PCAS succeeds
+      }
+    }
+  }
+
+  void
+  PFetchAddRandomly()
+  {
+    {  // wait for a main thread to release a lock
+      std::unique_lock lock{mtx_};
+      ++ready_num_;
+      cond_.wait(lock, [this] { return test_ready_; });
+    }
+
+    for (size_t i = 0; i < kExecNum; ++i) {
+      PFetchAdd(target_, 1UL);
+    }
+  }
+
   /*############################################################################
    * Internal member variables
    *##########################################################################*/
@@ -156,6 +286,8 @@ class PmemAtomicFixture : public ::testing::Test
 
   Target *target_{nullptr};
 
+  VersionedPtr *wide_target_{nullptr};
+
   std::atomic_size_t ready_num_{0};
 
   std::mutex mtx_{};
@@ -179,4 +311,34 @@ TEST_F(PmemAtomicFixture, PCASWithMultiThreadsCorrectlyIncrementTargets)
   VerifyPCAS(kTestThreadNum);
 }
 
+TEST_F(PmemAtomicFixture, WidePCASWithSingleThreadCorrectlyIncrementVersions)
+{  //
+  VerifyWidePCAS(1);
+}
+
+TEST_F(PmemAtomicFixture, WidePCASWithMultiThreadsCorrectlyIncrementVersions)
+{
+  VerifyWidePCAS(kTestThreadNum);
+}
+
+TEST_F(PmemAtomicFixture, PFetchAddWithSingleThreadCorrectlyIncrementTargets)
+{
+  VerifyPFetchAdd(1);
+}
+
+TEST_F(PmemAtomicFixture, PFetchAddWithMultiThreadsCorrectlyIncrementTargets)
+{
+  VerifyPFetchAdd(kTestThreadNum);
+}
+
+TEST_F(PmemAtomicFixture, PExchangeReturnsPreviousValues)
+{
+  VerifyPExchange();
+}
+
+TEST_F(PmemAtomicFixture, PFetchOrAndCorrectlyUpdateBits)
+{
+  VerifyPFetchOrAnd();
+}
+
 }  // namespace dbgroup::pmem::atomic::test
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/backoff.hpp"
+
+// C++ standard libraries
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/component/common.hpp"
+
+namespace dbgroup::pmem::atomic::component::test
+{
+class BackoffFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr uint64_t kCleanWord = 0xABCDUL;
+
+  static constexpr uint64_t kDirtyWord = kCleanWord | kDirtyFlag;
+
+  static constexpr WideWord kCleanWideWord =
+      (static_cast<WideWord>(kCleanWord) << 64U) | kCleanWord;
+
+  static constexpr WideWord kDirtyWideWord = kCleanWideWord | kWideDirtyFlag;
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    word_.store(kDirtyWord, std::memory_order_relaxed);
+    wide_word_ = kDirtyWideWord;
+  }
+
+  void
+  TearDown() override
+  {
+    SetBackoffPolicy(BackoffPolicy::kSleep);
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  void
+  VerifyWaitForWriter(  //
+      const BackoffPolicy policy)
+  {
+    SetBackoffPolicy(policy);
+    EXPECT_EQ(GetBackoffPolicy(), policy);
+
+    // a writer resolves the dirty word after readers start waiting
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < kTestThreadNum; ++i) {
+      threads.emplace_back([this] {
+        auto word = word_.load(std::memory_order_relaxed);
+        ResolveIntermediateState(&word_, word);
+        EXPECT_EQ(word, kCleanWord);
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds{1});
+    word_.store(kCleanWord, std::memory_order_release);
+    WakeWaiters(&word_);
+    for (auto &&t : threads) {
+      t.join();
+    }
+  }
+
+  void
+  VerifyResolveByItself(  //
+      const BackoffPolicy policy)
+  {
+    SetBackoffPolicy(policy);
+
+    // nobody resolves the dirty word, so a reader clears its dirty flag
+    auto word = word_.load(std::memory_order_relaxed);
+    ResolveIntermediateState(&word_, word);
+    EXPECT_EQ(word, kCleanWord);
+    EXPECT_EQ(word_.load(std::memory_order_relaxed), kCleanWord);
+  }
+
+  void
+  VerifyWideWaitForWriter(  //
+      const BackoffPolicy policy)
+  {
+    SetBackoffPolicy(policy);
+
+    // a writer resolves the upper half of the dirty double-width word
+    auto *upper = reinterpret_cast<std::atomic_uint64_t *>(&wide_word_) + 1;
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < kTestThreadNum; ++i) {
+      threads.emplace_back([this] { EXPECT_TRUE(LoadWideWord(&wide_word_) == kCleanWideWord); });
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds{1});
+    upper->store(kCleanWord, std::memory_order_release);
+    WakeWaiters(upper);
+    for (auto &&t : threads) {
+      t.join();
+    }
+  }
+
+  void
+  VerifyWideResolveByItself(  //
+      const BackoffPolicy policy)
+  {
+    SetBackoffPolicy(policy);
+
+    // nobody resolves the dirty double-width word, so a reader clears its dirty flag
+    EXPECT_TRUE(LoadWideWord(&wide_word_) == kCleanWideWord);
+    EXPECT_TRUE(wide_word_ == kCleanWideWord);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  std::atomic_uint64_t word_{0};
+
+  alignas(kWideWordSize) WideWord wide_word_{0};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(BackoffFixture, SleepWaitsForWriterToResolveDirtyWord)
+{
+  VerifyWaitForWriter(BackoffPolicy::kSleep);
+}
+
+TEST_F(BackoffFixture, PauseWaitsForWriterToResolveDirtyWord)
+{
+  VerifyWaitForWriter(BackoffPolicy::kPause);
+}
+
+TEST_F(BackoffFixture, WaitPkgWaitsForWriterToResolveDirtyWord)
+{
+  VerifyWaitForWriter(BackoffPolicy::kWaitPkg);
+}
+
+TEST_F(BackoffFixture, FutexWaitsForWriterToResolveDirtyWord)
+{
+  VerifyWaitForWriter(BackoffPolicy::kFutex);
+}
+
+TEST_F(BackoffFixture, SleepResolvesAbandonedDirtyWord)
+{
+  VerifyResolveByItself(BackoffPolicy::kSleep);
+}
+
+TEST_F(BackoffFixture, PauseResolvesAbandonedDirtyWord)
+{
+  VerifyResolveByItself(BackoffPolicy::kPause);
+}
+
+TEST_F(BackoffFixture, WaitPkgResolvesAbandonedDirtyWord)
+{
+  VerifyResolveByItself(BackoffPolicy::kWaitPkg);
+}
+
+TEST_F(BackoffFixture, FutexResolvesAbandonedDirtyWord)
+{
+  VerifyResolveByItself(BackoffPolicy::kFutex);
+}
+
+TEST_F(BackoffFixture, SleepWaitsForWriterToResolveDirtyWideWord)
+{
+  VerifyWideWaitForWriter(BackoffPolicy::kSleep);
+}
+
+TEST_F(BackoffFixture, PauseWaitsForWriterToResolveDirtyWideWord)
+{
+  VerifyWideWaitForWriter(BackoffPolicy::kPause);
+}
+
+TEST_F(BackoffFixture, WaitPkgWaitsForWriterToResolveDirtyWideWord)
+{
+  VerifyWideWaitForWriter(BackoffPolicy::kWaitPkg);
+}
+
+TEST_F(BackoffFixture, FutexWaitsForWriterToResolveDirtyWideWord)
+{
+  VerifyWideWaitForWriter(BackoffPolicy::kFutex);
+}
+
+TEST_F(BackoffFixture, SleepResolvesAbandonedDirtyWideWord)
+{
+  VerifyWideResolveByItself(BackoffPolicy::kSleep);
+}
+
+TEST_F(BackoffFixture, PauseResolvesAbandonedDirtyWideWord)
+{
+  VerifyWideResolveByItself(BackoffPolicy::kPause);
+}
+
+TEST_F(BackoffFixture, WaitPkgResolvesAbandonedDirtyWideWord)
+{
+  VerifyWideResolveByItself(BackoffPolicy::kWaitPkg);
+}
+
+TEST_F(BackoffFixture, FutexResolvesAbandonedDirtyWideWord)
+{
+  VerifyWideResolveByItself(BackoffPolicy::kFutex);
+}
+
+}  // namespace dbgroup::pmem::atomic::component::test
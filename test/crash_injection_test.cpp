@@ -0,0 +1,226 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/crash_injection.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+// external system libraries
+#include <libpmem.h>
+#include <libpmemobj.h>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// library headers
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
+
+// local sources
+#include "common.hpp"
+
+namespace dbgroup::pmem::atomic::component::test
+{
+// prepare a temporary directory
+auto *const env = testing::AddGlobalTestEnvironment(new TmpDirManager);
+
+class CrashInjectionFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr char kPoolName[] = "pmem_atomic_crash_injection_test";
+  static constexpr char kLayout[] = "pmem_atomic_crash_injection_test";
+  static constexpr char kDescPoolName[] = "pmem_atomic_crash_injection_desc_test";
+  static constexpr size_t kTargetNum = 2 * kPMwCASCapacity;
+  static constexpr size_t kArraySize = kWordSize * kTargetNum;
+  static constexpr size_t kMaxCrashPoint = 1000;
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    constexpr size_t kPoolSize = PMEMOBJ_MIN_POOL + kArraySize;
+
+    if constexpr (!kEnableCrashInjection) {
+      GTEST_SKIP() << "PMEM_ATOMIC_ENABLE_CRASH_INJECTION is disabled.";
+    }
+
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    if (std::filesystem::exists(pool_path)) {
+      pop_ = pmemobj_open(pool_path.c_str(), kLayout);
+    } else {
+      pop_ = pmemobj_create(pool_path.c_str(), kLayout, kPoolSize, kModeRW);
+    }
+    targets_ = static_cast<uint64_t *>(pmemobj_direct(pmemobj_root(pop_, kArraySize)));
+    ReopenDescriptorPool();
+  }
+
+  void
+  TearDown() override
+  {
+    desc_pool_.reset();
+    if (pop_ != nullptr) {
+      pmemobj_close(pop_);
+    }
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  /**
+   * @brief Crash an operation at each fence and check all-or-nothing updates.
+   *
+   * @tparam Func A class of operations.
+   * @param target_num The number of targets updated by the operation.
+   * @param desc_num The number of descriptors used by the operation.
+   * @param op An operation to increment the first `target_num` targets.
+   */
+  template <class Func>
+  void
+  VerifyCrashes(  //
+      const size_t target_num,
+      const size_t desc_num,
+      Func &&op)
+  {
+    for (size_t point = 0; point < kMaxCrashPoint; ++point) {
+      ResetTargets();
+
+      // run the operation until it reaches the crash point
+      RegisterCrashRegion(targets_, kArraySize);
+      for (size_t k = 0; k < desc_num; ++k) {
+        RegisterCrashRegion(desc_pool_->Get(k), PMwCASDescriptor::GetSize());
+      }
+      ArmCrash(point);
+      auto crashed = false;
+      try {
+        op();
+      } catch (const SimulatedCrash &) {
+        crashed = true;
+      }
+      DisarmCrash();
+
+      // drop unpersisted updates and recover descriptors
+      RestoreDurableImage();
+      ReopenDescriptorPool();
+
+      const auto first = PLoad(&(targets_[0]));
+      EXPECT_TRUE(first == 0UL || first == 1UL) << "crash point: " << point;
+      if (!crashed) {
+        EXPECT_EQ(first, 1UL);
+      }
+      for (size_t i = 1; i < target_num; ++i) {
+        EXPECT_EQ(PLoad(&(targets_[i])), first) << "crash point: " << point;
+      }
+      for (size_t i = target_num; i < kTargetNum; ++i) {
+        EXPECT_EQ(PLoad(&(targets_[i])), 0UL);
+      }
+
+      // recovered descriptors must be reusable
+      auto *desc = desc_pool_->Get();
+      desc->Add(&(targets_[0]), first, first + 1);
+      EXPECT_TRUE(desc->PMwCAS());
+      if (!crashed) return;
+    }
+    FAIL() << "the operation did not complete in " << kMaxCrashPoint << " fences.";
+  }
+
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  void
+  ResetTargets()
+  {
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      targets_[i] = 0;
+    }
+    pmem_persist(targets_, kArraySize);
+  }
+
+  void
+  ReopenDescriptorPool()
+  {
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kDescPoolName;
+    desc_pool_.reset();
+    desc_pool_ = std::make_unique<DescriptorPool>(pool_path);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  PMEMobjpool *pop_{nullptr};
+
+  uint64_t *targets_{nullptr};
+
+  std::unique_ptr<DescriptorPool> desc_pool_{nullptr};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(CrashInjectionFixture, PCASIsAtomicAtEveryCrashPoint)
+{
+  VerifyCrashes(1, 0, [&] {
+    uint64_t expected = 0;
+    PCAS(&(targets_[0]), expected, uint64_t{1});
+  });
+}
+
+TEST_F(CrashInjectionFixture, PMwCASIsAllOrNothingAtEveryCrashPoint)
+{
+  VerifyCrashes(kPMwCASCapacity, 1, [&] {
+    auto *desc = desc_pool_->Get();
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      desc->Add(&(targets_[i]), uint64_t{0}, uint64_t{1});
+    }
+    desc->PMwCAS();
+  });
+}
+
+TEST_F(CrashInjectionFixture, ChainedPMwCASIsAllOrNothingAtEveryCrashPoint)
+{
+  if constexpr (kDescNumPerThread < 2) {
+    GTEST_SKIP() << "PMEM_ATOMIC_DESCRIPTOR_NUM_PER_THREAD must be at least two.";
+  }
+
+  VerifyCrashes(kTargetNum, 2, [&] {
+    auto *desc = desc_pool_->Get();
+    desc->Extend(desc_pool_->Get(1));
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      desc->Add(&(targets_[i]), uint64_t{0}, uint64_t{1});
+    }
+    desc->PMwCAS();
+  });
+}
+
+}  // namespace dbgroup::pmem::atomic::component::test
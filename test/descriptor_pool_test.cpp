@@ -22,15 +22,22 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <future>
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+// external system libraries
+#include <libpmemobj.h>
+
 // external libraries
 #include "gtest/gtest.h"
 #include "thread/common.hpp"
@@ -51,6 +58,14 @@ class DescriptorPoolFixture : public ::testing::Test
    *##########################################################################*/
 
   static constexpr char kPoolName[] = "pmem_atomic_descriptor_pool_test";
+  static constexpr char kSmallPoolName[] = "pmem_atomic_descriptor_pool_small_test";
+  static constexpr char kReopenPoolName[] = "pmem_atomic_descriptor_pool_reopen_test";
+  static constexpr char kNUMAPoolName[] = "pmem_atomic_descriptor_pool_numa_test";
+  static constexpr char kShardPoolName[] = "pmem_atomic_descriptor_pool_shard_test";
+  static constexpr char kLazyPoolName[] = "pmem_atomic_descriptor_pool_lazy_test";
+  static constexpr char kTargetPoolName[] = "pmem_atomic_descriptor_pool_target_test";
+  static constexpr char kOldPoolName[] = "pmem_atomic_descriptor_pool_old_test";
+  static constexpr char kLayoutName[] = "pmwcas_desc_pool";
   static constexpr auto kMaxThreadNum = ::dbgroup::thread::kMaxThreadNum;
 
   /*############################################################################
@@ -83,6 +98,14 @@ class DescriptorPoolFixture : public ::testing::Test
 
       // check if they are the same descriptor
       EXPECT_EQ(desc_1, desc_2);
+
+      // check each thread has distinct descriptors in its ring
+      std::unordered_set<PMwCASDescriptor *> ring{};
+      for (size_t k = 0; k < kDescNumPerThread; ++k) {
+        ring.emplace(pool_->Get(k));
+        EXPECT_EQ(pool_->Get(k), pool_->Get(k));
+      }
+      EXPECT_EQ(ring.size(), kDescNumPerThread);
     };
 
     std::thread t{f};
@@ -136,6 +159,213 @@ class DescriptorPoolFixture : public ::testing::Test
     extra_t.join();
   }
 
+  void
+  VerifySmallCapacity()
+  {
+    constexpr size_t kCapacity = 2;
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kSmallPoolName;
+
+    {
+      DescriptorPool pool{pool_path, kLayoutName, kCapacity};
+      EXPECT_EQ(pool.GetCapacity(), kCapacity);
+
+      // an outer thread keeps its ID, so an inner one gets another descriptor
+      PMwCASDescriptor *desc_1{};
+      PMwCASDescriptor *desc_2{};
+      std::thread t{[&] {
+        desc_1 = pool.Get();
+        std::thread inner_t{[&] { desc_2 = pool.Get(); }};
+        inner_t.join();
+      }};
+      t.join();
+      EXPECT_NE(desc_1, desc_2);
+      EXPECT_EQ(desc_1->Capacity(), kCapacity);
+
+      // descriptors are placed at intervals of their own size
+      const auto diff = reinterpret_cast<std::byte *>(desc_1) - reinterpret_cast<std::byte *>(desc_2);
+      const auto dist = static_cast<size_t>(diff < 0 ? -diff : diff);
+      EXPECT_EQ(dist % PMwCASDescriptor::GetSize(kCapacity), 0UL);
+    }
+
+    // the pool cannot be reopened with a different capacity
+    EXPECT_THROW(DescriptorPool(pool_path, kLayoutName, kCapacity + 1), std::runtime_error);
+    EXPECT_THROW(DescriptorPool(pool_path, kLayoutName, 0), std::invalid_argument);
+    EXPECT_THROW(DescriptorPool(pool_path, kLayoutName, kPMwCASCapacity + 1), std::invalid_argument);
+  }
+
+  void
+  VerifyOldLayout()
+  {
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kOldPoolName;
+    std::filesystem::remove(pool_path);
+
+    // older layouts placed descriptors at the head of a root object
+    auto *pop = pmemobj_create(pool_path.c_str(), kLayoutName, PMEMOBJ_MIN_POOL, kModeRW);
+    ASSERT_NE(pop, nullptr);
+    pmemobj_root(pop, kPMEMLineSize + PMwCASDescriptor::GetSize());
+    pmemobj_close(pop);
+
+    EXPECT_THROW(DescriptorPool(pool_path, kLayoutName), std::runtime_error);
+  }
+
+  void
+  VerifyReopen()
+  {
+    constexpr size_t kCapacity = 2;
+    constexpr size_t kReopenNum = 3;
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kReopenPoolName;
+
+    for (size_t i = 0; i < kReopenNum; ++i) {
+      DescriptorPool pool{pool_path, kLayoutName, kCapacity};
+      std::thread t{[&] {
+        auto *desc = pool.Get();
+        EXPECT_EQ(desc->Capacity(), kCapacity);
+        EXPECT_FALSE(desc->IsPending());
+      }};
+      t.join();
+    }
+  }
+
+  void
+  VerifyThreadSlots()
+  {
+    constexpr size_t kSlotNum = 2;
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kShardPoolName;
+
+    for (size_t loop = 0; loop < 2; ++loop) {
+      DescriptorPool pool{pool_path, ThreadSlots{kSlotNum, [] { return size_t{1}; }}};
+      EXPECT_EQ(pool.GetSlotNum(), kSlotNum);
+
+      // each slot has its own ring of descriptors
+      std::unordered_set<PMwCASDescriptor *> descs{};
+      for (size_t slot = 0; slot < kSlotNum; ++slot) {
+        for (size_t k = 0; k < kDescNumPerThread; ++k) {
+          auto *desc = pool.GetInSlot(slot, k);
+          EXPECT_FALSE(desc->IsPending());
+          descs.emplace(desc);
+        }
+      }
+      EXPECT_EQ(descs.size(), kSlotNum * kDescNumPerThread);
+
+      // the mapper selects the slot of the current thread
+      EXPECT_EQ(pool.Get(), pool.GetInSlot(1));
+    }
+
+    {  // threads out of the slots cannot get descriptors
+      DescriptorPool pool{pool_path, ThreadSlots{kSlotNum, [] { return kSlotNum; }}};
+      EXPECT_THROW(pool.Get(), std::out_of_range);
+      EXPECT_THROW(pool.GetInSlot(kSlotNum), std::out_of_range);
+    }
+    EXPECT_THROW(DescriptorPool(pool_path, ThreadSlots{kSlotNum + 1}), std::runtime_error);
+    EXPECT_THROW(DescriptorPool(pool_path, ThreadSlots{0}), std::invalid_argument);
+  }
+
+  void
+  VerifyLazyRecovery(  //
+      const bool read_before_update)
+  {
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kLazyPoolName;
+    auto &&target_path = GetTmpPoolPath();
+    target_path /= kTargetPoolName;
+    std::filesystem::remove(pool_path);
+    std::filesystem::remove(target_path);
+    auto *pop = pmemobj_create(target_path.c_str(), kLayoutName, PMEMOBJ_MIN_POOL, kModeRW);
+    ASSERT_NE(pop, nullptr);
+    auto *target = static_cast<uint64_t *>(pmemobj_direct(pmemobj_root(pop, kWordSize)));
+
+    {  // emulate a crash before updating the target with the desired value
+      DescriptorPool pool{pool_path, kLayoutName};
+      std::thread t{[&] {
+        auto *desc = pool.Get();
+        desc->Add(target, 0UL, 1UL);
+        ASSERT_TRUE(desc->StartPMwCAS());
+        *target = desc->GetDescWord();
+      }};
+      t.join();
+    }
+
+    {  // the target is recovered when it is read or updated after lazy opening
+      DescriptorPool pool{pool_path, kLayoutName, kPMwCASCapacity, true};
+      if (read_before_update) {
+        EXPECT_EQ(PLoad(target), 1UL);
+      }
+      std::thread t{[&] {
+        auto *desc = pool.Get();
+        EXPECT_FALSE(desc->IsPending());
+        desc->Add(target, 1UL, 2UL);
+        EXPECT_TRUE(desc->PMwCAS());
+      }};
+      t.join();
+    }
+    EXPECT_EQ(PLoad(target), 2UL);
+
+    pmemobj_close(pop);
+  }
+
+  void
+  VerifyMultiPools()
+  {
+    constexpr size_t kNodeNum = 2;
+    std::vector<std::string> paths{};
+    for (size_t i = 0; i < kNodeNum; ++i) {
+      auto &&pool_path = GetTmpPoolPath();
+      pool_path /= std::string{kNUMAPoolName} + "_" + std::to_string(i);
+      paths.emplace_back(pool_path);
+    }
+
+    for (size_t loop = 0; loop < 2; ++loop) {
+      DescriptorPool pool{paths, kLayoutName};
+      std::thread t{[&] {
+        auto *desc = pool.Get();
+        EXPECT_EQ(desc->Capacity(), kPMwCASCapacity);
+        EXPECT_FALSE(desc->IsPending());
+      }};
+      t.join();
+    }
+
+    EXPECT_THROW(DescriptorPool(std::vector<std::string>{}, kLayoutName), std::invalid_argument);
+  }
+
+  void
+  VerifyVolatilePool()
+  {
+    constexpr size_t kCapacity = 2;
+    DescriptorPool pool{kVolatile, kCapacity};
+    EXPECT_EQ(pool.GetCapacity(), kCapacity);
+
+    // targets on DRAM are updated by PMwCAS without any pmemobj pool
+    uint64_t words[kCapacity]{};
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < kTestThreadNum; ++i) {
+      threads.emplace_back([&] {
+        auto *desc = pool.Get();
+        EXPECT_FALSE(desc->IsPersistent());
+        EXPECT_EQ(desc->Capacity(), kCapacity);
+        for (size_t j = 0; j < kExecNum; ++j) {
+          while (true) {
+            const auto old_0 = PLoad(&words[0], std::memory_order_relaxed);
+            const auto old_1 = PLoad(&words[1], std::memory_order_relaxed);
+            desc->Add(&words[0], old_0, old_0 + 1, std::memory_order_relaxed);
+            desc->Add(&words[1], old_1, old_1 + 1, std::memory_order_relaxed);
+            if (desc->PMwCAS()) break;
+          }
+        }
+      });
+    }
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    EXPECT_EQ(words[0], kExecNum * kTestThreadNum);
+    EXPECT_EQ(words[1], kExecNum * kTestThreadNum);
+    EXPECT_THROW(DescriptorPool(kVolatile, 0), std::invalid_argument);
+  }
+
  private:
   /*############################################################################
    * Internal utility functions
@@ -189,4 +419,44 @@ TEST_F(DescriptorPoolFixture, GetDifferentDescriptorsInAllThreadTwice)
   GetAllDescriptor(kMaxThreadNum);
 }
 
+TEST_F(DescriptorPoolFixture, ReopenedPoolProvidesInitializedDescriptors)
+{  //
+  VerifyReopen();
+}
+
+TEST_F(DescriptorPoolFixture, PoolWithOldLayoutCannotBeOpened)
+{  //
+  VerifyOldLayout();
+}
+
+TEST_F(DescriptorPoolFixture, PoolWithThreadSlotsProvidesDescriptorsPerSlot)
+{  //
+  VerifyThreadSlots();
+}
+
+TEST_F(DescriptorPoolFixture, LazilyOpenedPoolRecoversDescriptorsOnDemand)
+{  //
+  VerifyLazyRecovery(true);
+}
+
+TEST_F(DescriptorPoolFixture, LazilyOpenedPoolRecoversDescriptorsOnPMwCAS)
+{  //
+  VerifyLazyRecovery(false);
+}
+
+TEST_F(DescriptorPoolFixture, MultiPoolsForNUMANodesProvideInitializedDescriptors)
+{  //
+  VerifyMultiPools();
+}
+
+TEST_F(DescriptorPoolFixture, VolatilePoolPerformsPMwCASOnDRAM)
+{  //
+  VerifyVolatilePool();
+}
+
+TEST_F(DescriptorPoolFixture, PoolWithSmallCapacityPlacesDescriptorsCompactly)
+{  //
+  VerifySmallCapacity();
+}
+
 }  // namespace dbgroup::pmem::atomic::test
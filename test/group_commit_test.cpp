@@ -0,0 +1,335 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// the corresponding header
+#include "pmem/atomic/component/group_commit.hpp"
+
+// C++ standard libraries
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// external system libraries
+#include <libpmem.h>
+#include <libpmemobj.h>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/pmwcas_descriptor.hpp"
+
+namespace dbgroup::pmem::atomic::test
+{
+// prepare a temporary directory
+auto *const env = testing::AddGlobalTestEnvironment(new TmpDirManager);
+
+class GroupCommitFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Type aliases
+   *##########################################################################*/
+
+  using Target = uint64_t;
+
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr char kPoolName[] = "pmem_atomic_group_commit_test";
+  static constexpr char kLayout[] = "pmem_atomic_group_commit_test";
+  static constexpr size_t kTargetNum = kGroupCommitCapacity / 2;
+  static constexpr size_t kCommitInterval = 16;
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    constexpr size_t kArraySize = kWordSize * kTargetNum;
+    constexpr size_t kPoolSize = PMEMOBJ_MIN_POOL + kArraySize + sizeof(PMwCASDescriptor);
+
+    test_ready_ = false;
+    ready_num_ = 0;
+
+    // create a persistent pool for testing
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    if (std::filesystem::exists(pool_path)) {
+      pop_ = pmemobj_open(pool_path.c_str(), kLayout);
+    } else {
+      pop_ = pmemobj_create(pool_path.c_str(), kLayout, kPoolSize, kModeRW);
+    }
+
+    // initialize target fields
+    auto &&root = pmemobj_root(pop_, kArraySize);
+    targets_ = reinterpret_cast<Target *>(pmemobj_direct(root));
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      targets_[i] = 0UL;
+    }
+    pmem_persist(targets_, kArraySize);
+  }
+
+  void
+  TearDown() override
+  {
+    if (pop_ != nullptr) {
+      pmemobj_close(pop_);
+    }
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  void
+  VerifyDeferredDirtyFlags()
+  {
+    BeginGroupCommit();
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      auto expected = 0UL;
+      ASSERT_TRUE(PCAS(&(targets_[i]), expected, i + 1));
+      EXPECT_EQ((RawLoad(i) & kDirtyFlag) != 0, kUseDirtyFlag);
+    }
+
+    Commit();
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      EXPECT_EQ(RawLoad(i), i + 1);
+    }
+
+    // this thread can read its own dirty words before commit
+    auto expected = 1UL;
+    ASSERT_TRUE(PCAS(&(targets_[0]), expected, 0UL));
+    EXPECT_EQ(PLoad(&(targets_[0])), 0UL);
+    EXPECT_EQ(RawLoad(0), 0UL);
+    EndGroupCommit();
+  }
+
+  void
+  VerifyRMWDirtyFlags()
+  {
+    constexpr size_t kRMWNum = 4;
+    ASSERT_EQ(PExchange(&(targets_[3]), 7UL), 0UL);
+
+    BeginGroupCommit();
+    EXPECT_EQ(PFetchAdd(&(targets_[0]), 1UL), 0UL);
+    EXPECT_EQ(PExchange(&(targets_[1]), 2UL), 0UL);
+    EXPECT_EQ(PFetchOr(&(targets_[2]), 3UL), 0UL);
+    EXPECT_EQ(PFetchAnd(&(targets_[3]), 4UL), 7UL);
+
+    // dirty flags are kept until commit only if they are enabled
+    for (size_t i = 0; i < kRMWNum; ++i) {
+      EXPECT_EQ((RawLoad(i) & kDirtyFlag) != 0, kUseDirtyFlag);
+    }
+
+    Commit();
+    for (size_t i = 0; i < kRMWNum; ++i) {
+      EXPECT_EQ(RawLoad(i), i + 1);
+    }
+    EndGroupCommit();
+  }
+
+  void
+  VerifyPCAS(  //
+      const size_t thread_num)
+  {
+    // run a function over multi-threads
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back(&GroupCommitFixture::PCASInGroupCommit, this);
+    }
+
+    {  // wait for all workers to finish initialization
+      while (ready_num_ < thread_num) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+      std::lock_guard x_guard{mtx_};
+      test_ready_ = true;
+    }
+    cond_.notify_all();
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    // check the total number of modifications
+    size_t sum = 0;
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      sum += RawLoad(i);
+    }
+    EXPECT_EQ(kExecNum * thread_num, sum);
+  }
+
+  void
+  VerifyDeferredPMwCAS()
+  {
+    PMEMoid oid{OID_NULL};
+    auto *desc = AllocateDescriptor(oid);
+
+    BeginGroupCommit();
+    desc->Add(&(targets_[0]), 0UL, 1UL);
+    desc->Add(&(targets_[1]), 0UL, 1UL);
+    ASSERT_TRUE(desc->PMwCAS());
+    EXPECT_EQ(PLoad(&(targets_[0])), 1UL);
+    EXPECT_EQ(PLoad(&(targets_[1])), 1UL);
+    EXPECT_EQ(desc->Size(), 2UL);  // the descriptor keeps its log until commit
+
+    EndGroupCommit();
+    EXPECT_EQ(desc->Size(), 0UL);
+    pmemobj_free(&oid);
+  }
+
+  void
+  VerifyCommitAtThreadExit()
+  {
+    PMEMoid oid{OID_NULL};
+    auto *desc = AllocateDescriptor(oid);
+
+    // a thread exits without ending its group commit
+    std::thread t{[&] {
+      BeginGroupCommit();
+      auto expected = 0UL;
+      ASSERT_TRUE(PCAS(&(targets_[0]), expected, 1UL));
+      desc->Add(&(targets_[1]), 0UL, 1UL);
+      ASSERT_TRUE(desc->PMwCAS());
+    }};
+    t.join();
+
+    EXPECT_EQ(RawLoad(0), 1UL);
+    EXPECT_EQ(RawLoad(1), 1UL);
+    EXPECT_FALSE(desc->IsPending());
+    pmemobj_free(&oid);
+  }
+
+ private:
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  auto
+  RawLoad(  //
+      const size_t i)  //
+      -> uint64_t
+  {
+    return reinterpret_cast<std::atomic_uint64_t *>(&(targets_[i]))->load();
+  }
+
+  /**
+   * @param[out] oid The allocated object.
+   * @return A descriptor aligned to a PMEM line in the object.
+   */
+  auto
+  AllocateDescriptor(  //
+      PMEMoid &oid)  //
+      -> PMwCASDescriptor *
+  {
+    if (pmemobj_zalloc(pop_, &oid, sizeof(PMwCASDescriptor) + kPMEMLineSize, 0) != 0) {
+      throw std::runtime_error{pmemobj_errormsg()};
+    }
+    auto addr = reinterpret_cast<uintptr_t>(pmemobj_direct(oid));
+    addr = (addr + kPMEMLineSize - 1) & ~(kPMEMLineSize - 1);
+    auto *desc = reinterpret_cast<PMwCASDescriptor *>(addr);
+    desc->Initialize();
+    return desc;
+  }
+
+  void
+  PCASInGroupCommit()
+  {
+    {  // wait for a main thread to release a lock
+      std::unique_lock lock{mtx_};
+      ++ready_num_;
+      cond_.wait(lock, [this] { return test_ready_; });
+    }
+
+    BeginGroupCommit();
+    for (size_t i = 0; i < kExecNum; ++i) {
+      auto *target = &(targets_[i % kTargetNum]);
+      auto cur_val = PLoad(target);
+      while (!PCAS(target, cur_val, cur_val + 1)) {
+        // continue until PCAS succeeds
+      }
+      if (i % kCommitInterval == kCommitInterval - 1) {
+        Commit();
+      }
+    }
+    EndGroupCommit();
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  PMEMobjpool *pop_{nullptr};
+
+  Target *targets_{nullptr};
+
+  std::atomic_size_t ready_num_{0};
+
+  std::mutex mtx_{};
+
+  std::condition_variable cond_{};
+
+  bool test_ready_{false};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(GroupCommitFixture, PCASInGroupCommitDefersClearingDirtyFlags)
+{  //
+  VerifyDeferredDirtyFlags();
+}
+
+TEST_F(GroupCommitFixture, RMWInGroupCommitDefersClearingDirtyFlags)
+{  //
+  VerifyRMWDirtyFlags();
+}
+
+TEST_F(GroupCommitFixture, PCASWithSingleThreadInGroupCommitCorrectlyIncrementTargets)
+{  //
+  VerifyPCAS(1);
+}
+
+TEST_F(GroupCommitFixture, PCASWithMultiThreadsInGroupCommitCorrectlyIncrementTargets)
+{
+  VerifyPCAS(kTestThreadNum);
+}
+
+TEST_F(GroupCommitFixture, PMwCASInGroupCommitIsFinishedByCommit)
+{  //
+  VerifyDeferredPMwCAS();
+}
+
+TEST_F(GroupCommitFixture, ThreadExitInGroupCommitCommitsBufferedUpdates)
+{  //
+  VerifyCommitAtThreadExit();
+}
+
+}  // namespace dbgroup::pmem::atomic::test
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/patomic.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// external system libraries
+#include <libpmem.h>
+#include <libpmemobj.h>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+
+namespace dbgroup::pmem::atomic::test
+{
+// prepare a temporary directory
+auto *const env = testing::AddGlobalTestEnvironment(new TmpDirManager);
+
+template <class PMwCASTarget>
+class PAtomicFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Type aliases
+   *##########################################################################*/
+
+  using Counter = PAtomic<uint64_t, PMwCASTarget::value>;
+
+  using Pointer = PAtomic<uint64_t *, PMwCASTarget::value>;
+
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr char kPoolName[] = "pmem_atomic_patomic_test";
+  static constexpr char kLayout[] = "pmem_atomic_patomic_test";
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    constexpr size_t kPoolSize = PMEMOBJ_MIN_POOL;
+
+    // create a persistent pool for testing
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    if (std::filesystem::exists(pool_path)) {
+      pop_ = pmemobj_open(pool_path.c_str(), kLayout);
+    } else {
+      pop_ = pmemobj_create(pool_path.c_str(), kLayout, kPoolSize, kModeRW);
+    }
+
+    // initialize target fields
+    auto &&root = pmemobj_root(pop_, 2 * kWordSize);
+    auto *addr = static_cast<std::byte *>(pmemobj_direct(root));
+    counter_ = new (addr) Counter{0};
+    pointer_ = new (addr + kWordSize) Pointer{nullptr};
+    pmem_persist(addr, 2 * kWordSize);
+  }
+
+  void
+  TearDown() override
+  {
+    if (pop_ != nullptr) {
+      pmemobj_close(pop_);
+    }
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  void
+  VerifyLoadStore()
+  {
+    counter_->store(1UL);
+    EXPECT_EQ(counter_->load(), 1UL);
+    EXPECT_EQ(counter_->exchange(2UL), 1UL);
+    EXPECT_EQ(counter_->load(), 2UL);
+
+    auto *ptr = counter_->address();
+    pointer_->store(ptr);
+    EXPECT_EQ(pointer_->load(), ptr);
+    EXPECT_EQ(pointer_->exchange(nullptr), ptr);
+    EXPECT_EQ(pointer_->load(), nullptr);
+  }
+
+  void
+  VerifyCompareExchange()
+  {
+    auto expected = 1UL;
+    EXPECT_FALSE(counter_->compare_exchange(expected, 2UL));
+    EXPECT_EQ(expected, 0UL);
+    EXPECT_TRUE(counter_->compare_exchange(expected, 2UL));
+    EXPECT_EQ(counter_->load(), 2UL);
+  }
+
+  void
+  VerifyBitwiseRMW()
+  {
+    constexpr uint64_t kLowBits = 0b0101UL;
+    constexpr uint64_t kHighBits = 0b1010UL;
+
+    EXPECT_EQ(counter_->fetch_or(kLowBits), 0UL);
+    EXPECT_EQ(counter_->fetch_or(kHighBits), kLowBits);
+    EXPECT_EQ(counter_->fetch_and(kHighBits), kLowBits | kHighBits);
+    EXPECT_EQ(counter_->load(), kHighBits);
+  }
+
+  void
+  VerifyFetchAdd(  //
+      const size_t thread_num)
+  {
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back([this] {
+        for (size_t j = 0; j < kExecNum; ++j) {
+          counter_->fetch_add(1UL);
+        }
+      });
+    }
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    EXPECT_EQ(counter_->load(), kExecNum * thread_num);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  PMEMobjpool *pop_{nullptr};
+
+  Counter *counter_{nullptr};
+
+  Pointer *pointer_{nullptr};
+};
+
+/*##############################################################################
+ * Preparation for typed testing
+ *############################################################################*/
+
+using PMwCASTargets = ::testing::Types<std::true_type, std::false_type>;
+TYPED_TEST_SUITE(PAtomicFixture, PMwCASTargets);
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TYPED_TEST(PAtomicFixture, StoreAndExchangeUpdateWords)
+{
+  TestFixture::VerifyLoadStore();
+}
+
+TYPED_TEST(PAtomicFixture, CompareExchangeWithExpectedValueUpdateWords)
+{
+  TestFixture::VerifyCompareExchange();
+}
+
+TYPED_TEST(PAtomicFixture, FetchOrAndCorrectlyUpdateBits)
+{
+  TestFixture::VerifyBitwiseRMW();
+}
+
+TYPED_TEST(PAtomicFixture, FetchAddWithSingleThreadCorrectlyIncrementCounter)
+{
+  TestFixture::VerifyFetchAdd(1);
+}
+
+TYPED_TEST(PAtomicFixture, FetchAddWithMultiThreadsCorrectlyIncrementCounter)
+{
+  TestFixture::VerifyFetchAdd(kTestThreadNum);
+}
+
+}  // namespace dbgroup::pmem::atomic::test
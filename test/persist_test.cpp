@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/persist.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+// external system libraries
+#include <libpmemobj.h>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+
+namespace dbgroup::pmem::atomic::component::test
+{
+// prepare a temporary directory
+auto *const env = testing::AddGlobalTestEnvironment(new TmpDirManager);
+
+class PersistFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr char kPoolName[] = "pmem_atomic_persist_test";
+  static constexpr char kLayout[] = "pmem_atomic_persist_test";
+
+  static constexpr size_t kRegionSize = 4 * kCacheLineSize;
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    constexpr size_t kPoolSize = PMEMOBJ_MIN_POOL;
+
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    if (std::filesystem::exists(pool_path)) {
+      pop_ = pmemobj_open(pool_path.c_str(), kLayout);
+    } else {
+      pop_ = pmemobj_create(pool_path.c_str(), kLayout, kPoolSize, kModeRW);
+    }
+    region_ = static_cast<std::byte *>(pmemobj_direct(pmemobj_root(pop_, kRegionSize)));
+  }
+
+  void
+  TearDown() override
+  {
+    if (pop_ != nullptr) {
+      pmemobj_close(pop_);
+    }
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  void
+  VerifyPersist(  //
+      const size_t offset,
+      const size_t size)
+  {
+    std::memset(region_ + offset, 0xFF, size);
+    Persist(region_ + offset, size);
+
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(region_[offset + i], std::byte{0xFF});
+    }
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  PMEMobjpool *pop_{nullptr};
+
+  std::byte *region_{nullptr};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(PersistFixture, GetFlushTypeReturnsSameTypeForEachCall)
+{
+  const auto type = GetFlushType();
+  EXPECT_EQ(type, DetectFlushType());
+  EXPECT_EQ(type, GetFlushType());
+}
+
+TEST_F(PersistFixture, PersistWordKeepsWrittenValues)
+{
+  VerifyPersist(0, kWordSize);
+}
+
+TEST_F(PersistFixture, PersistUnalignedRegionKeepsWrittenValues)
+{
+  VerifyPersist(kWordSize + 1, 2 * kCacheLineSize);
+}
+
+}  // namespace dbgroup::pmem::atomic::component::test
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/persistent_list.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// external system libraries
+#include <libpmemobj.h>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+
+namespace dbgroup::pmem::atomic::test
+{
+// prepare a temporary directory
+auto *const env = testing::AddGlobalTestEnvironment(new TmpDirManager);
+
+class PersistentListFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr char kPoolName[] = "pmem_atomic_persistent_list_test";
+  static constexpr char kLayout[] = "pmem_atomic_persistent_list_test";
+  static constexpr char kDescPoolName[] = "pmem_atomic_persistent_list_desc_test";
+  static constexpr size_t kKeyNum = 1000;  // a list is traversed linearly
+  static constexpr size_t kCapacity = kKeyNum * kTestThreadNum;
+  static constexpr size_t kRegionSize = PersistentList::GetRegionSize(kCapacity);
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    if constexpr (kPMwCASCapacity < 5) {
+      GTEST_SKIP() << "PMEM_ATOMIC_PMWCAS_CAPACITY must be at least five.";
+    }
+
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    std::filesystem::remove(pool_path);
+    pop_ = pmemobj_create(pool_path.c_str(), kLayout, PMEMOBJ_MIN_POOL + kRegionSize, kModeRW);
+
+    auto &&desc_path = GetTmpPoolPath();
+    desc_path /= kDescPoolName;
+    desc_pool_ = std::make_unique<DescriptorPool>(desc_path);
+    OpenList();
+  }
+
+  void
+  TearDown() override
+  {
+    list_.reset();
+    desc_pool_.reset();
+    if (pop_ != nullptr) {
+      pmemobj_close(pop_);
+    }
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  void
+  VerifySingleThread()
+  {
+    uint64_t value{};
+
+    // inserted pairs can be read, and duplicate keys are rejected
+    for (size_t i = 0; i < kKeyNum; ++i) {
+      const auto key = (i * 7) % kKeyNum;  // insert keys out of order
+      ASSERT_TRUE(list_->Insert(key, key + 1));
+      ASSERT_FALSE(list_->Insert(key, key + 2));
+    }
+    for (size_t key = 0; key < kKeyNum; ++key) {
+      ASSERT_TRUE(list_->Read(key, value));
+      EXPECT_EQ(value, key + 1);
+    }
+    EXPECT_FALSE(list_->Read(kKeyNum, value));
+
+    // update odd keys and delete even keys
+    for (size_t key = 0; key < kKeyNum; ++key) {
+      if (key % 2 == 0) {
+        ASSERT_TRUE(list_->Delete(key));
+        ASSERT_FALSE(list_->Delete(key));
+        ASSERT_FALSE(list_->Update(key, key));
+      } else {
+        ASSERT_TRUE(list_->Update(key, key));
+      }
+    }
+    for (size_t key = 0; key < kKeyNum; ++key) {
+      ASSERT_EQ(list_->Read(key, value), key % 2 == 1);
+      if (key % 2 == 1) {
+        EXPECT_EQ(value, key);
+      }
+    }
+    EXPECT_EQ(list_->AllocatedNum(), kKeyNum);
+  }
+
+  void
+  VerifyMultiThreads()
+  {
+    // threads insert interleaved keys and delete half of them concurrently
+    std::vector<std::thread> threads{};
+    for (size_t t = 0; t < kTestThreadNum; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t i = 0; i < kKeyNum; ++i) {
+          ASSERT_TRUE(list_->Insert(i * kTestThreadNum + t, t));
+        }
+        for (size_t i = 0; i < kKeyNum; i += 2) {
+          ASSERT_TRUE(list_->Delete(i * kTestThreadNum + t));
+        }
+      });
+    }
+    for (auto &&thread : threads) {
+      thread.join();
+    }
+
+    uint64_t value{};
+    for (size_t i = 0; i < kKeyNum; ++i) {
+      for (size_t t = 0; t < kTestThreadNum; ++t) {
+        ASSERT_EQ(list_->Read(i * kTestThreadNum + t, value), i % 2 == 1);
+        if (i % 2 == 1) {
+          EXPECT_EQ(value, t);
+        }
+      }
+    }
+
+    // all the nodes have been allocated
+    EXPECT_FALSE(list_->Insert(kCapacity, 0));
+  }
+
+  void
+  VerifyUpdateWithConcurrentDelete()
+  {
+    for (size_t key = 0; key < kKeyNum; ++key) {
+      ASSERT_TRUE(list_->Insert(key, 0));
+    }
+
+    // a thread deletes keys while the others keep updating the same keys
+    std::vector<std::thread> threads{};
+    threads.emplace_back([&] {
+      for (size_t key = 0; key < kKeyNum; ++key) {
+        ASSERT_TRUE(list_->Delete(key));
+      }
+    });
+    for (size_t t = 1; t < kTestThreadNum; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t key = 0; key < kKeyNum; ++key) {
+          for (uint64_t v = t; list_->Update(key, v); v += kTestThreadNum) {
+            // continue until the key is deleted
+          }
+        }
+      });
+    }
+    for (auto &&thread : threads) {
+      thread.join();
+    }
+
+    // no update overwrites a descriptor, so all the nodes are tombstoned
+    uint64_t value{};
+    const auto *nodes = reinterpret_cast<const uint64_t *>(region_) + 1;
+    for (size_t key = 0; key < kKeyNum; ++key) {
+      EXPECT_FALSE(list_->Read(key, value));
+      const auto *node = &(nodes[(key + 1) * 3]);
+      EXPECT_EQ(node[1], PersistentList::kMaxValue + 1);
+      EXPECT_EQ(node[2] & kIsIntermediate, 0UL);
+    }
+  }
+
+  void
+  VerifyReopen()
+  {
+    for (size_t key = 0; key < kKeyNum; ++key) {
+      ASSERT_TRUE(list_->Insert(key, key));
+    }
+    ASSERT_TRUE(list_->Delete(0));
+
+    // the list is restored from its region as is
+    list_.reset();
+    pmemobj_close(pop_);
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    pop_ = pmemobj_open(pool_path.c_str(), kLayout);
+    OpenList();
+
+    uint64_t value{};
+    EXPECT_FALSE(list_->Read(0, value));
+    for (size_t key = 1; key < kKeyNum; ++key) {
+      ASSERT_TRUE(list_->Read(key, value));
+      EXPECT_EQ(value, key);
+    }
+    EXPECT_EQ(list_->AllocatedNum(), kKeyNum);
+  }
+
+ private:
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  void
+  OpenList()
+  {
+    region_ = pmemobj_direct(pmemobj_root(pop_, kRegionSize));
+    list_ = std::make_unique<PersistentList>(region_, kCapacity, *desc_pool_);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  PMEMobjpool *pop_{nullptr};
+
+  std::unique_ptr<DescriptorPool> desc_pool_{nullptr};
+
+  std::unique_ptr<PersistentList> list_{nullptr};
+
+  void *region_{nullptr};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(PersistentListFixture, OperationsWithSingleThreadCorrectlyUpdateList)
+{  //
+  VerifySingleThread();
+}
+
+TEST_F(PersistentListFixture, OperationsWithMultiThreadsCorrectlyUpdateList)
+{  //
+  VerifyMultiThreads();
+}
+
+TEST_F(PersistentListFixture, UpdateWithConcurrentDeleteNeverOverwritesDescriptors)
+{  //
+  VerifyUpdateWithConcurrentDelete();
+}
+
+TEST_F(PersistentListFixture, ReopenedListKeepsItsContents)
+{  //
+  VerifyReopen();
+}
+
+}  // namespace dbgroup::pmem::atomic::test
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/persistent_ring_buffer.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// external system libraries
+#include <libpmemobj.h>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+
+namespace dbgroup::pmem::atomic::test
+{
+// prepare a temporary directory
+auto *const env = testing::AddGlobalTestEnvironment(new TmpDirManager);
+
+class PersistentRingBufferFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Constants
+   *##########################################################################*/
+
+  static constexpr char kPoolName[] = "pmem_atomic_persistent_ring_buffer_test";
+  static constexpr char kLayout[] = "pmem_atomic_persistent_ring_buffer_test";
+  static constexpr char kDescPoolName[] = "pmem_atomic_persistent_ring_buffer_desc_test";
+  static constexpr size_t kCapacity = 64;
+  static constexpr size_t kRegionSize = PersistentRingBuffer::GetRegionSize(kCapacity);
+
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    std::filesystem::remove(pool_path);
+    pop_ = pmemobj_create(pool_path.c_str(), kLayout, PMEMOBJ_MIN_POOL + kRegionSize, kModeRW);
+
+    auto &&desc_path = GetTmpPoolPath();
+    desc_path /= kDescPoolName;
+    desc_pool_ = std::make_unique<DescriptorPool>(desc_path);
+    OpenBuffer();
+  }
+
+  void
+  TearDown() override
+  {
+    buffer_.reset();
+    desc_pool_.reset();
+    pmemobj_close(pop_);
+  }
+
+  /*############################################################################
+   * Functions for verification
+   *##########################################################################*/
+
+  void
+  VerifySingleThread()
+  {
+    uint64_t value{};
+
+    // values are popped in FIFO order over several laps
+    for (size_t lap = 0; lap < 3; ++lap) {
+      EXPECT_FALSE(buffer_->Pop(value));
+      for (size_t i = 0; i < kCapacity; ++i) {
+        ASSERT_TRUE(buffer_->Push(lap * kCapacity + i));
+      }
+      EXPECT_FALSE(buffer_->Push(0));
+      EXPECT_EQ(buffer_->Size(), kCapacity);
+      for (size_t i = 0; i < kCapacity; ++i) {
+        ASSERT_TRUE(buffer_->Pop(value));
+        EXPECT_EQ(value, lap * kCapacity + i);
+      }
+    }
+    EXPECT_EQ(buffer_->Size(), 0UL);
+  }
+
+  void
+  VerifyMultiThreads()
+  {
+    std::vector<std::vector<uint64_t>> popped(kTestThreadNum);
+
+    // each producer pushes its ID and sequence numbers, and consumers pop them
+    std::vector<std::thread> threads{};
+    for (size_t t = 0; t < kTestThreadNum; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t i = 0; i < kExecNum; ++i) {
+          while (!buffer_->Push(i * kTestThreadNum + t)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+      threads.emplace_back([&, t] {
+        uint64_t value{};
+        while (popped[t].size() < kExecNum) {
+          if (buffer_->Pop(value)) {
+            popped[t].emplace_back(value);
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (auto &&thread : threads) {
+      thread.join();
+    }
+
+    // every value is popped exactly once in the order of each producer
+    std::vector<size_t> counts(kTestThreadNum * kExecNum, 0);
+    for (const auto &values : popped) {
+      std::vector<uint64_t> last(kTestThreadNum, 0);
+      std::vector<bool> seen(kTestThreadNum, false);
+      for (const auto value : values) {
+        const auto producer = value % kTestThreadNum;
+        if (seen[producer]) {
+          EXPECT_LT(last[producer], value);
+        }
+        seen[producer] = true;
+        last[producer] = value;
+        ++counts[value];
+      }
+    }
+    for (const auto count : counts) {
+      ASSERT_EQ(count, 1UL);
+    }
+  }
+
+  void
+  VerifyReopen()
+  {
+    for (size_t i = 0; i < kCapacity / 2; ++i) {
+      ASSERT_TRUE(buffer_->Push(i));
+    }
+    uint64_t value{};
+    ASSERT_TRUE(buffer_->Pop(value));
+
+    // the buffer is restored from its region as is
+    buffer_.reset();
+    pmemobj_close(pop_);
+    auto &&pool_path = GetTmpPoolPath();
+    pool_path /= kPoolName;
+    pop_ = pmemobj_open(pool_path.c_str(), kLayout);
+    OpenBuffer();
+
+    EXPECT_EQ(buffer_->Size(), kCapacity / 2 - 1);
+    for (size_t i = 1; i < kCapacity / 2; ++i) {
+      ASSERT_TRUE(buffer_->Pop(value));
+      EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(buffer_->Pop(value));
+  }
+
+ private:
+  /*############################################################################
+   * Internal utility functions
+   *##########################################################################*/
+
+  void
+  OpenBuffer()
+  {
+    auto *region = pmemobj_direct(pmemobj_root(pop_, kRegionSize));
+    buffer_ = std::make_unique<PersistentRingBuffer>(region, kCapacity, *desc_pool_);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  PMEMobjpool *pop_{nullptr};
+
+  std::unique_ptr<DescriptorPool> desc_pool_{nullptr};
+
+  std::unique_ptr<PersistentRingBuffer> buffer_{nullptr};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(PersistentRingBufferFixture, OperationsWithSingleThreadKeepFIFOOrder)
+{  //
+  VerifySingleThread();
+}
+
+TEST_F(PersistentRingBufferFixture, OperationsWithMultiThreadsPopEachValueOnce)
+{  //
+  VerifyMultiThreads();
+}
+
+TEST_F(PersistentRingBufferFixture, ReopenedBufferKeepsItsContents)
+{  //
+  VerifyReopen();
+}
+
+}  // namespace dbgroup::pmem::atomic::test
@@ -28,8 +28,14 @@
 #include <random>
 #include <stdexcept>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+// system libraries
+#if defined(PMEM_ATOMIC_USE_HTM) || defined(PMEM_ATOMIC_USE_SINGLE_LINE_HTM)
+#include <cpuid.h>
+#endif
+
 // external system libraries
 #include <libpmem.h>
 #include <libpmemobj.h>
@@ -100,6 +106,9 @@ class PMwCASDescriptorFixture : public ::testing::Test
   void
   TearDown() override
   {
+    if (!OID_IS_NULL(lines_oid_)) {
+      pmemobj_free(&lines_oid_);
+    }
     if (pop_ != nullptr) {
       pmemobj_close(pop_);
     }
@@ -140,6 +149,598 @@ class PMwCASDescriptorFixture : public ::testing::Test
     EXPECT_EQ(kExecNum * thread_num * kPMwCASCapacity, sum);
   }
 
+  void
+  VerifyPMwCASWithDuplicateTargets()
+  {
+    auto *desc = AllocateDescriptor();
+
+    // add the same addresses twice in the reverse order
+    for (size_t i = kPMwCASCapacity; i > 0; --i) {
+      desc->Add(&(target_fields_[i - 1]), 0UL, 1UL);
+    }
+    for (size_t i = kPMwCASCapacity; i > 0; --i) {
+      desc->Add(&(target_fields_[i - 1]), 1UL, 2UL);
+    }
+    EXPECT_EQ(desc->Size(), kPMwCASCapacity);
+    EXPECT_TRUE(desc->PMwCAS());
+
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      EXPECT_EQ(PLoad(&(target_fields_[i])), 2UL);
+    }
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyPMwCASWithMismatchedDuplicateTargets()
+  {
+    auto *desc = AllocateDescriptor();
+    auto *f = target_fields_;
+
+    // the second update does not expect the desired value of the first one
+    PMwCASConflict conflict{};
+    desc->Add(&(f[0]), 0UL, 1UL);
+    desc->Add(&(f[1]), 0UL, 1UL);
+    desc->Add(&(f[1]), 2UL, 3UL);
+    EXPECT_FALSE(desc->PMwCAS(conflict));
+    EXPECT_EQ(conflict.addr, &(f[1]));
+    EXPECT_EQ(conflict.index, 1UL);
+    EXPECT_FALSE(conflict.IsInProgress());
+    EXPECT_FALSE(desc->IsPending());
+    EXPECT_EQ(PLoad(&(f[0])), 0UL);
+    EXPECT_EQ(PLoad(&(f[1])), 0UL);
+
+    // the descriptor can be reused after the failure
+    desc->Add(&(f[1]), 0UL, 1UL);
+    desc->Add(&(f[1]), 1UL, 2UL);
+    EXPECT_TRUE(desc->PMwCAS());
+    EXPECT_EQ(PLoad(&(f[1])), 2UL);
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyTargetsInAnotherPool()
+  {
+    auto *desc = AllocateDescriptor();
+    auto *f = target_fields_;
+    uint64_t volatile_word = 0;
+
+    // a persistent descriptor rejects targets out of the pool of the first one
+    desc->Add(&(f[0]), 0UL, 1UL);
+    EXPECT_THROW(desc->Add(&volatile_word, 0UL, 1UL), std::invalid_argument);
+    EXPECT_EQ(desc->Size(), 1UL);
+    EXPECT_TRUE(desc->PMwCAS());
+    EXPECT_EQ(PLoad(&(f[0])), 1UL);
+
+    // fixed-arity operations discard all the given targets
+    EXPECT_THROW(desc->PMwCAS(PMwCASEntry{&(f[0]), 1UL, 2UL},  //
+                              PMwCASEntry{&volatile_word, 0UL, 1UL}),
+                 std::invalid_argument);
+    EXPECT_EQ(desc->Size(), 0UL);
+    EXPECT_EQ(PLoad(&(f[0])), 1UL);
+    EXPECT_EQ(volatile_word, 0UL);
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyMisalignedDescriptor()
+  {
+    // descriptor words embed sequence numbers into the alignment bits
+    alignas(kPMEMLineSize) std::byte buf[2 * PMwCASDescriptor::GetSize()]{};
+    auto *desc = reinterpret_cast<PMwCASDescriptor *>(buf + kWordSize);
+    EXPECT_THROW(desc->Initialize(kPMwCASCapacity, false), std::invalid_argument);
+  }
+
+  void
+  VerifyPMwCASWithStaleExpectedValues()
+  {
+    auto *desc = AllocateDescriptor();
+
+    // the last target has a stale expected value
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      desc->Add(&(target_fields_[i]), (i == kPMwCASCapacity - 1) ? 1UL : 0UL, 2UL);
+    }
+    EXPECT_FALSE(desc->PMwCAS());
+    EXPECT_EQ(desc->Size(), 0UL);
+    EXPECT_FALSE(desc->IsPending());
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      EXPECT_EQ(PLoad(&(target_fields_[i])), 0UL);
+    }
+
+    // the descriptor can be reused after the early failure
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      desc->Add(&(target_fields_[i]), 0UL, 1UL);
+    }
+    EXPECT_TRUE(desc->PMwCAS());
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyFixedArityPMwCAS()
+  {
+    auto *desc = AllocateDescriptor();
+    auto *f = target_fields_;
+
+    // targets given in descending order are updated together
+    EXPECT_TRUE(desc->PMwCAS(PMwCASEntry{&f[2], 0UL, 3UL},  //
+                             PMwCASEntry{&f[1], 0UL, 2UL},  //
+                             PMwCASEntry{&f[0], 0UL, 1UL, std::memory_order_relaxed}));
+    EXPECT_FALSE(desc->IsPending());
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(PLoad(&(f[i])), i + 1);
+    }
+
+    // a stale expected value fails without any updates
+    EXPECT_FALSE(desc->PMwCAS(PMwCASEntry{&f[0], 1UL, 4UL}, PMwCASEntry{&f[1], 0UL, 4UL}));
+    EXPECT_EQ(PLoad(&(f[0])), 1UL);
+    EXPECT_EQ(PLoad(&(f[1])), 2UL);
+
+    // targets added beforehand are discarded
+    desc->Add(&(f[2]), 3UL, 5UL);
+    EXPECT_TRUE(desc->PMwCAS(PMwCASEntry{&f[0], 1UL, 6UL}));
+    EXPECT_EQ(PLoad(&(f[0])), 6UL);
+    EXPECT_EQ(PLoad(&(f[2])), 3UL);
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyPMwCASConflict()
+  {
+    auto *desc = AllocateDescriptor();
+    auto *f = target_fields_;
+    f[1] = 2UL;
+
+    // a failed operation reports the target with a stale expected value
+    PMwCASConflict conflict{};
+    desc->Add(&(f[0]), 0UL, 1UL);
+    desc->Add(&(f[1]), 0UL, 1UL);
+    desc->Add(&(f[2]), 0UL, 1UL);
+    EXPECT_FALSE(desc->PMwCAS(conflict));
+    EXPECT_EQ(conflict.addr, &(f[1]));
+    EXPECT_EQ(conflict.index, 1UL);
+    EXPECT_EQ(conflict.observed, 2UL);
+    EXPECT_FALSE(conflict.IsInProgress());
+
+    // a retry rereads only the conflicting target
+    size_t attempt_num = 0;
+    Target expected[3] = {0UL, 0UL, 0UL};
+    EXPECT_TRUE(desc->PMwCASWithRetry([&](PMwCASDescriptor &d, const PMwCASConflict *prev) {
+      if (prev != nullptr) {
+        EXPECT_EQ(prev->addr, &(f[1]));
+        expected[prev->index] = PLoad(&(f[prev->index]));
+      }
+      for (size_t i = 0; i < 3; ++i) {
+        d.Add(&(f[i]), expected[i], expected[i] + 1);
+      }
+      ++attempt_num;
+      return true;
+    }));
+    EXPECT_EQ(attempt_num, 2UL);
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(PLoad(&(f[i])), expected[i] + 1);
+    }
+
+    // a retry wrapper gives up by a given function or the number of retries
+    EXPECT_FALSE(desc->PMwCASWithRetry([](PMwCASDescriptor &, const PMwCASConflict *) {  //
+      return false;
+    }));
+    attempt_num = 0;
+    EXPECT_FALSE(desc->PMwCASWithRetry(
+        [&](PMwCASDescriptor &d, const PMwCASConflict *) {
+          d.Add(&(f[0]), 0UL, 1UL);
+          ++attempt_num;
+          return true;
+        },
+        2));
+    EXPECT_EQ(attempt_num, 3UL);
+    EXPECT_EQ(PLoad(&(f[0])), 1UL);
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyPipelinedPMwCAS()
+  {
+    constexpr size_t kDescNum = 2;
+    PMwCASDescriptor *descs[kDescNum] = {AllocateDescriptor(), AllocateDescriptor()};
+
+    // start PMwCAS operations alternately without waiting for the previous one
+    for (size_t loop = 0; loop < kExecNum; ++loop) {
+      auto *desc = descs[loop % kDescNum];
+      for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+        desc->Add(&(target_fields_[i]), loop, loop + 1);
+      }
+      ASSERT_TRUE(desc->StartPMwCAS());
+      for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+        ASSERT_EQ(PLoad(&(target_fields_[i])), loop + 1);
+      }
+    }
+
+    for (auto *desc : descs) {
+      desc->FinishPMwCAS();
+      EXPECT_EQ(desc->Size(), 0UL);
+      FreeDescriptor(desc);
+    }
+  }
+
+  void
+  VerifyPMwCASWithSmallCapacity()
+  {
+    constexpr size_t kCapacity = 2;
+    auto *desc = AllocateDescriptor(kCapacity);
+    EXPECT_EQ(desc->Capacity(), kCapacity);
+    EXPECT_LE(PMwCASDescriptor::GetSize(kCapacity), PMwCASDescriptor::GetSize());
+
+    for (size_t loop = 0; loop < kExecNum; ++loop) {
+      for (size_t i = 0; i < kCapacity; ++i) {
+        desc->Add(&(target_fields_[i]), loop, loop + 1);
+      }
+      ASSERT_TRUE(desc->PMwCAS());
+    }
+
+    for (size_t i = 0; i < kCapacity; ++i) {
+      EXPECT_EQ(PLoad(&(target_fields_[i])), kExecNum);
+    }
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyChainedPMwCAS(  //
+      const size_t thread_num)
+  {
+    constexpr size_t kCapacity = 2;
+    constexpr size_t kDescNum = 3;
+    constexpr size_t kTargetNum = kCapacity * kDescNum - 1;
+
+    // each thread increments all the targets with a chain of small descriptors
+    auto worker = [&] {
+      PMwCASDescriptor *descs[kDescNum];
+      for (auto &&desc : descs) {
+        desc = AllocateDescriptor(kCapacity);
+      }
+      for (size_t loop = 0; loop < kExecNum; ++loop) {
+        while (true) {
+          for (size_t i = 1; i < kDescNum; ++i) {
+            descs[0]->Extend(descs[i]);
+          }
+          for (size_t i = kTargetNum; i > 0; --i) {
+            auto *addr = &(target_fields_[i - 1]);
+            const auto cur_val = PLoad(addr);
+            descs[0]->Add(addr, cur_val, cur_val + 1);
+          }
+          if (descs[0]->PMwCAS()) break;
+        }
+        for (auto &&desc : descs) {
+          EXPECT_EQ(desc->Size(), 0UL);
+        }
+      }
+      for (auto &&desc : descs) {
+        FreeDescriptor(desc);
+      }
+    };
+
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      EXPECT_EQ(PLoad(&(target_fields_[i])), kExecNum * thread_num);
+    }
+  }
+
+  void
+  VerifyChainRecovery()
+  {
+    constexpr size_t kCapacity = 2;
+    constexpr size_t kTargetNum = kCapacity + 1;
+    constexpr uint64_t kFirstSeq = 1UL;  // that of zero-filled descriptors
+    auto *head = AllocateDescriptor(kCapacity);
+    auto *overflow = AllocateDescriptor(kCapacity);
+
+    // decide a chained PMwCAS operation
+    head->Extend(overflow);
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      head->Add(&(target_fields_[i]), 0UL, 1UL);
+    }
+    ASSERT_TRUE(head->StartPMwCAS());
+
+    // emulate a crash before updating the targets with the desired values
+    const auto desc_word = reinterpret_cast<uint64_t>(head) | kPMwCASFlag | kFirstSeq;
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      target_fields_[i] = desc_word;
+    }
+
+    // the head recovers all the targets even if the overflow one is the first
+    overflow->Initialize(kCapacity);
+    head->Initialize(kCapacity);
+    for (size_t i = 0; i < kTargetNum; ++i) {
+      EXPECT_EQ(PLoad(&(target_fields_[i])), 1UL);
+    }
+    EXPECT_EQ(overflow->Size(), 0UL);
+    EXPECT_FALSE(head->IsPending());
+
+    FreeDescriptor(overflow);
+    FreeDescriptor(head);
+  }
+
+  void
+  VerifyPLoadReadOnly()
+  {
+    constexpr uint64_t kFirstSeq = 1UL;  // that of zero-filled descriptors
+    auto *desc = AllocateDescriptor();
+    auto *addr = &(target_fields_[0]);
+
+    // a dirty word is read without clearing its dirty flag
+    *addr = 1UL | kDirtyFlag;
+    EXPECT_EQ(PLoadReadOnly(addr), 1UL);
+    EXPECT_EQ(*addr, 1UL | kDirtyFlag);
+
+    // emulate a stalled owner after deciding its PMwCAS operation
+    *addr = 1UL;
+    desc->Add(addr, 1UL, 2UL);
+    ASSERT_TRUE(desc->StartPMwCAS());
+    const auto desc_word = reinterpret_cast<uint64_t>(desc) | kPMwCASFlag | kFirstSeq;
+    *addr = desc_word;
+
+    // the desired value is read without completing the operation
+    EXPECT_EQ(PLoadReadOnly(addr), 2UL);
+    EXPECT_EQ(*addr, desc_word);
+    EXPECT_TRUE(desc->IsPending());
+
+    *addr = 2UL;
+    desc->FinishPMwCAS();
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifyPMwReadWithConcurrentPMwCAS()
+  {
+    std::atomic_bool running{true};
+
+    // a writer increments all the targets at once
+    std::thread writer{[&] {
+      auto *desc = AllocateDescriptor();
+      for (size_t loop = 0; loop < kExecNum; ++loop) {
+        // helping readers finish embedding instead of rolling back the operation
+        for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+          desc->Add(&(target_fields_[i]), loop, loop + 1);
+        }
+        ASSERT_TRUE(desc->PMwCAS());
+      }
+      running = false;
+      FreeDescriptor(desc);
+    }};
+
+    // readers must not observe partially updated targets
+    std::vector<std::thread> readers{};
+    for (size_t i = 0; i < kTestThreadNum; ++i) {
+      readers.emplace_back([&] {
+        Target *addrs[kPMwCASCapacity];
+        Target values[kPMwCASCapacity];
+        for (size_t j = 0; j < kPMwCASCapacity; ++j) {
+          addrs[j] = &(target_fields_[j]);
+        }
+        do {
+          PMwRead(addrs, values, kPMwCASCapacity);
+          for (size_t j = 1; j < kPMwCASCapacity; ++j) {
+            ASSERT_EQ(values[0], values[j]);
+          }
+        } while (running);
+      });
+    }
+
+    writer.join();
+    for (auto &&t : readers) {
+      t.join();
+    }
+  }
+
+#ifdef PMEM_ATOMIC_HELP_PMWCAS
+  void
+  VerifyPMwCASWithHelpingThreads()
+  {
+    constexpr size_t kWriterNum = 2;
+    std::atomic_bool running{true};
+
+    // writers embed descriptors in opposite orders to block each other
+    std::vector<std::thread> writers{};
+    for (size_t w = 0; w < kWriterNum; ++w) {
+      writers.emplace_back([&, w] {
+        auto *desc = AllocateDescriptor();
+        for (size_t loop = 0; loop < kExecNum; ++loop) {
+          while (true) {
+            for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+              auto *addr = &(target_fields_[w == 0 ? i : kPMwCASCapacity - 1 - i]);
+              const auto cur_val = PLoad(addr);
+              desc->Add(addr, cur_val, cur_val + 1);
+            }
+            if (desc->PMwCAS()) break;
+          }
+        }
+        FreeDescriptor(desc);
+      });
+    }
+
+    // readers help the writers whenever they find embedded descriptors
+    std::vector<std::thread> readers{};
+    for (size_t i = 0; i < kTestThreadNum; ++i) {
+      readers.emplace_back([&] {
+        do {
+          for (size_t j = 0; j < kPMwCASCapacity; ++j) {
+            PLoad(&(target_fields_[j]));
+          }
+        } while (running);
+      });
+    }
+
+    for (auto &&t : writers) {
+      t.join();
+    }
+    running = false;
+    for (auto &&t : readers) {
+      t.join();
+    }
+
+    // all the targets must be incremented together
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      EXPECT_EQ(PLoad(&(target_fields_[i])), kExecNum * kWriterNum);
+    }
+  }
+#endif
+
+#ifdef PMEM_ATOMIC_USE_HTM
+  void
+  VerifyHTMEmbedding()
+  {
+    if (!HasRTM()) {
+      GTEST_SKIP() << "Intel RTM is not available.";
+    }
+
+    constexpr size_t kWordNumPerLine = kCacheLineSize / kWordSize;
+    auto *desc = AllocateDescriptor();
+    auto *lines = AllocateLines(kPMwCASCapacity);
+    auto *dirty_word = reinterpret_cast<std::atomic_uint64_t *>(&(lines[kWordNumPerLine]));
+
+    // an intermediate target aborts a transaction, so embedding falls back to CAS
+    dirty_word->store(kDirtyFlag);
+    PMwCASConflict conflict{};
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      desc->Add(&(lines[i * kWordNumPerLine]), 0UL, 1UL);
+    }
+    EXPECT_FALSE(desc->PMwCAS(conflict));
+    EXPECT_EQ(conflict.addr, &(lines[kWordNumPerLine]));
+    EXPECT_TRUE(conflict.IsInProgress());
+    dirty_word->store(0UL);
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      EXPECT_EQ(PLoad(&(lines[i * kWordNumPerLine])), 0UL);
+    }
+    FreeDescriptor(desc);
+
+    // threads embed descriptors into the same targets in different lines
+    std::vector<std::thread> threads{};
+    for (size_t t = 0; t < kTestThreadNum; ++t) {
+      threads.emplace_back([&] {
+        auto *d = AllocateDescriptor();
+        for (size_t i = 0; i < kExecNum; ++i) {
+          while (true) {
+            for (size_t j = 0; j < kPMwCASCapacity; ++j) {
+              auto *addr = &(lines[j * kWordNumPerLine]);
+              const auto cur_val = PLoad(addr);
+              d->Add(addr, cur_val, cur_val + 1);
+            }
+            if (d->PMwCAS()) break;
+          }
+        }
+        FreeDescriptor(d);
+      });
+    }
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    for (size_t i = 0; i < kPMwCASCapacity; ++i) {
+      EXPECT_EQ(PLoad(&(lines[i * kWordNumPerLine])), kExecNum * kTestThreadNum);
+    }
+  }
+#endif
+
+#ifdef PMEM_ATOMIC_USE_SINGLE_LINE_HTM
+  void
+  VerifySingleLinePMwCAS()
+  {
+    constexpr size_t kWordNumPerLine = kCacheLineSize / kWordSize;
+    auto *desc = AllocateDescriptor();
+    auto *line = AllocateLines(2);
+
+    // targets in one line are updated without descriptors if RTM is available
+    auto desc_word = desc->GetDescWord();
+    desc->Add(&(line[0]), 0UL, 1UL);
+    desc->Add(&(line[kWordNumPerLine - 1]), 0UL, 1UL);
+    EXPECT_TRUE(desc->PMwCAS());
+    EXPECT_EQ(desc->GetDescWord() == desc_word, HasRTM());
+    EXPECT_FALSE(desc->IsPending());
+    EXPECT_EQ(PLoad(&(line[0])), 1UL);
+    EXPECT_EQ(PLoad(&(line[kWordNumPerLine - 1])), 1UL);
+
+    // targets over two lines always use the descriptor
+    desc_word = desc->GetDescWord();
+    desc->Add(&(line[kWordNumPerLine - 1]), 1UL, 2UL);
+    desc->Add(&(line[kWordNumPerLine]), 0UL, 1UL);
+    EXPECT_TRUE(desc->PMwCAS());
+    EXPECT_NE(desc->GetDescWord(), desc_word);
+    EXPECT_EQ(PLoad(&(line[kWordNumPerLine - 1])), 2UL);
+    EXPECT_EQ(PLoad(&(line[kWordNumPerLine])), 1UL);
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifySingleLineFallback()
+  {
+    auto *desc = AllocateDescriptor();
+    auto *line = AllocateLines(1);
+    auto *dirty_word = reinterpret_cast<std::atomic_uint64_t *>(&(line[1]));
+
+    // an intermediate target aborts transactions, so the usual protocol is used
+    dirty_word->store(kDirtyFlag);
+    const auto desc_word = desc->GetDescWord();
+    PMwCASConflict conflict{};
+    desc->Add(&(line[0]), 0UL, 1UL);
+    desc->Add(&(line[1]), 0UL, 1UL);
+    EXPECT_FALSE(desc->PMwCAS(conflict));
+    EXPECT_NE(desc->GetDescWord(), desc_word);
+    EXPECT_EQ(conflict.addr, &(line[1]));
+    EXPECT_TRUE(conflict.IsInProgress());
+    EXPECT_EQ(PLoad(&(line[0])), 0UL);
+
+    // the operation succeeds after the target is resolved
+    dirty_word->store(0UL);
+    desc->Add(&(line[0]), 0UL, 1UL);
+    desc->Add(&(line[1]), 0UL, 1UL);
+    EXPECT_TRUE(desc->PMwCAS());
+    EXPECT_EQ(PLoad(&(line[0])), 1UL);
+    EXPECT_EQ(PLoad(&(line[1])), 1UL);
+    FreeDescriptor(desc);
+  }
+
+  void
+  VerifySingleLinePMwCASWithMultiThreads()
+  {
+    constexpr size_t kTargetNum = 3;
+    auto *line = AllocateLines(1);
+
+    // threads increment the same line, so transactions conflict or see stale values
+    std::vector<std::thread> threads{};
+    for (size_t t = 0; t < kTestThreadNum; ++t) {
+      threads.emplace_back([&] {
+        auto *desc = AllocateDescriptor();
+        for (size_t i = 0; i < kExecNum; ++i) {
+          desc->PMwCASWithRetry([&](PMwCASDescriptor &d, const PMwCASConflict *prev) {
+            if (prev != nullptr && prev->addr != nullptr) {
+              EXPECT_GE(prev->addr, static_cast<const void *>(line));
+              EXPECT_LT(prev->addr, static_cast<const void *>(line + kTargetNum));
+            }
+            for (size_t j = 0; j < kTargetNum; ++j) {
+              const auto cur_val = PLoad(&(line[j]));
+              d.Add(&(line[j]), cur_val, cur_val + 1);
+            }
+            return true;
+          });
+        }
+        FreeDescriptor(desc);
+      });
+    }
+    for (auto &&t : threads) {
+      t.join();
+    }
+
+    for (size_t j = 0; j < kTargetNum; ++j) {
+      EXPECT_EQ(PLoad(&(line[j])), kExecNum * kTestThreadNum);
+    }
+  }
+#endif
+
  private:
   /*############################################################################
    * Internal utility functions
@@ -174,12 +775,7 @@ class PMwCASDescriptorFixture : public ::testing::Test
     }
 
     // prepare descriptor
-    PMEMoid oid{OID_NULL};
-    if (pmemobj_zalloc(pop_, &oid, sizeof(PMwCASDescriptor), 0) != 0) {
-      throw std::runtime_error{pmemobj_errormsg()};
-    }
-    auto *desc = reinterpret_cast<PMwCASDescriptor *>(pmemobj_direct(oid));
-    desc->Initialize();
+    auto *desc = AllocateDescriptor();
 
     // run PMwCAS
     for (auto &&targets : operations) {
@@ -192,7 +788,72 @@ class PMwCASDescriptorFixture : public ::testing::Test
         if (desc->PMwCAS()) break;
       }
     }
-    pmemobj_free(&oid);
+    FreeDescriptor(desc);
+  }
+
+  /**
+   * @param num The number of cache lines.
+   * @return Zero-filled words aligned to a cache line.
+   */
+  auto
+  AllocateLines(  //
+      const size_t num)  //
+      -> Target *
+  {
+    if (pmemobj_zalloc(pop_, &lines_oid_, kCacheLineSize * (num + 1), 0) != 0) {
+      throw std::runtime_error{pmemobj_errormsg()};
+    }
+    auto addr = reinterpret_cast<uintptr_t>(pmemobj_direct(lines_oid_));
+    addr = (addr + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+    return reinterpret_cast<Target *>(addr);
+  }
+
+#if defined(PMEM_ATOMIC_USE_HTM) || defined(PMEM_ATOMIC_USE_SINGLE_LINE_HTM)
+  /**
+   * @retval true if the CPU supports Intel RTM.
+   * @retval false otherwise.
+   */
+  static auto
+  HasRTM()  //
+      -> bool
+  {
+    unsigned int eax{};
+    unsigned int ebx{};
+    unsigned int ecx{};
+    unsigned int edx{};
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 && (ebx & bit_RTM) != 0;
+  }
+#endif
+
+  auto
+  AllocateDescriptor(  //
+      const size_t capacity = kPMwCASCapacity)  //
+      -> PMwCASDescriptor *
+  {
+    // descriptors must be aligned to PMEM lines
+    PMEMoid oid{OID_NULL};
+    const auto size = PMwCASDescriptor::GetSize(capacity) + kPMEMLineSize;
+    if (pmemobj_zalloc(pop_, &oid, size, 0) != 0) {
+      throw std::runtime_error{pmemobj_errormsg()};
+    }
+    auto addr = reinterpret_cast<uintptr_t>(pmemobj_direct(oid));
+    addr = (addr + kPMEMLineSize - 1) & ~(kPMEMLineSize - 1);
+    auto *desc = reinterpret_cast<PMwCASDescriptor *>(addr);
+    desc->Initialize(capacity);
+
+    std::lock_guard guard{desc_mtx_};
+    desc_oids_.emplace(desc, oid);
+    return desc;
+  }
+
+  void
+  FreeDescriptor(  //
+      PMwCASDescriptor *desc)
+  {
+    std::lock_guard guard{desc_mtx_};
+    auto &&iter = desc_oids_.find(desc);
+    pmemobj_free(&(iter->second));
+    desc_oids_.erase(iter);
   }
 
   /*############################################################################
@@ -203,6 +864,8 @@ class PMwCASDescriptorFixture : public ::testing::Test
 
   Target *target_fields_{nullptr};
 
+  PMEMoid lines_oid_{OID_NULL};
+
   std::uniform_int_distribution<size_t> id_dist_{0, kPMwCASCapacity - 1};
 
   std::atomic_size_t ready_num_{0};
@@ -212,6 +875,10 @@ class PMwCASDescriptorFixture : public ::testing::Test
   std::condition_variable cond_{};
 
   bool test_ready_{false};
+
+  std::mutex desc_mtx_{};
+
+  std::unordered_map<PMwCASDescriptor *, PMEMoid> desc_oids_{};
 };
 
 /*##############################################################################
@@ -228,4 +895,110 @@ TEST_F(PMwCASDescriptorFixture, PMwCASWithMultiThreadsCorrectlyIncrementTargets)
   VerifyPMwCAS(kTestThreadNum);
 }
 
+TEST_F(PMwCASDescriptorFixture, PMwCASWithDuplicateTargetsChainUpdates)
+{  //
+  VerifyPMwCASWithDuplicateTargets();
+}
+
+TEST_F(PMwCASDescriptorFixture, PMwCASWithMismatchedDuplicateTargetsFails)
+{  //
+  VerifyPMwCASWithMismatchedDuplicateTargets();
+}
+
+TEST_F(PMwCASDescriptorFixture, PMwCASWithStaleExpectedValuesFailWithoutUpdates)
+{  //
+  VerifyPMwCASWithStaleExpectedValues();
+}
+
+TEST_F(PMwCASDescriptorFixture, PersistentDescriptorRejectsTargetsInAnotherPool)
+{  //
+  VerifyTargetsInAnotherPool();
+}
+
+TEST_F(PMwCASDescriptorFixture, MisalignedDescriptorCannotBeInitialized)
+{  //
+  VerifyMisalignedDescriptor();
+}
+
+TEST_F(PMwCASDescriptorFixture, FixedArityPMwCASCorrectlyUpdateTargets)
+{  //
+  VerifyFixedArityPMwCAS();
+}
+
+TEST_F(PMwCASDescriptorFixture, FailedPMwCASReportsConflictingTargets)
+{  //
+  VerifyPMwCASConflict();
+}
+
+TEST_F(PMwCASDescriptorFixture, PipelinedPMwCASWithTwoDescriptorsCorrectlyUpdateTargets)
+{  //
+  VerifyPipelinedPMwCAS();
+}
+
+TEST_F(PMwCASDescriptorFixture, PMwReadWithConcurrentPMwCASReturnConsistentSnapshots)
+{
+  VerifyPMwReadWithConcurrentPMwCAS();
+}
+
+TEST_F(PMwCASDescriptorFixture, PLoadReadOnlyReturnsLogicalValuesWithoutWrites)
+{  //
+  VerifyPLoadReadOnly();
+}
+
+TEST_F(PMwCASDescriptorFixture, PMwCASWithSmallCapacityCorrectlyUpdateTargets)
+{  //
+  VerifyPMwCASWithSmallCapacity();
+}
+
+TEST_F(PMwCASDescriptorFixture, ChainedPMwCASWithSingleThreadCorrectlyIncrementTargets)
+{  //
+  VerifyChainedPMwCAS(1);
+}
+
+TEST_F(PMwCASDescriptorFixture, ChainedPMwCASWithMultiThreadsCorrectlyIncrementTargets)
+{  //
+  VerifyChainedPMwCAS(kTestThreadNum);
+}
+
+TEST_F(PMwCASDescriptorFixture, InitializeRecoversAllTargetsInChain)
+{  //
+  VerifyChainRecovery();
+}
+
+TEST_F(PMwCASDescriptorFixture, DescriptorWithThreeTargetsFitsInOnePMEMLine)
+{
+  EXPECT_EQ(PMwCASDescriptor::GetSize(3), kPMEMLineSize);
+}
+
+#ifdef PMEM_ATOMIC_HELP_PMWCAS
+TEST_F(PMwCASDescriptorFixture, PMwCASWithHelpingThreadsCorrectlyIncrementTargets)
+{  //
+  VerifyPMwCASWithHelpingThreads();
+}
+#endif
+
+#ifdef PMEM_ATOMIC_USE_HTM
+TEST_F(PMwCASDescriptorFixture, HTMEmbeddingWithConflictsFallsBackToCAS)
+{  //
+  VerifyHTMEmbedding();
+}
+#endif
+
+#ifdef PMEM_ATOMIC_USE_SINGLE_LINE_HTM
+TEST_F(PMwCASDescriptorFixture, SingleLinePMwCASSkipsDescriptorsOnlyForOneLine)
+{  //
+  VerifySingleLinePMwCAS();
+}
+
+TEST_F(PMwCASDescriptorFixture, SingleLinePMwCASFallsBackToDescriptorsOnAborts)
+{  //
+  VerifySingleLineFallback();
+}
+
+TEST_F(PMwCASDescriptorFixture, SingleLinePMwCASWithMultiThreadsCorrectlyIncrementTargets)
+{  //
+  VerifySingleLinePMwCASWithMultiThreads();
+}
+#endif
+
 }  // namespace dbgroup::pmem::atomic::test
@@ -134,6 +134,22 @@ class PMwCASTargetFixture : public ::testing::Test
     }
   }
 
+  void
+  VerifyMayHaveExpectedValue(  //
+      const bool expect_fail)
+  {
+    if (expect_fail) {
+      *target_ = new_val_;
+    }
+    EXPECT_EQ(pmwcas_target_.MayHaveExpectedValue(), !expect_fail);
+
+    // an embedded descriptor is treated as the expected value
+    if (!expect_fail) {
+      ASSERT_TRUE(pmwcas_target_.EmbedDescriptor(desc_));
+      EXPECT_TRUE(pmwcas_target_.MayHaveExpectedValue());
+    }
+  }
+
   void
   VerifyCompletePMwCAS(  //
       const bool succeeded)
@@ -141,10 +157,10 @@ class PMwCASTargetFixture : public ::testing::Test
     ASSERT_TRUE(pmwcas_target_.EmbedDescriptor(desc_));
 
     if (succeeded) {
-      pmwcas_target_.Redo();
+      pmwcas_target_.Redo(desc_);
       EXPECT_EQ(new_val_, *target_);
     } else {
-      pmwcas_target_.Undo();
+      pmwcas_target_.Undo(desc_);
       EXPECT_EQ(old_val_, *target_);
     }
   }
@@ -155,7 +171,7 @@ class PMwCASTargetFixture : public ::testing::Test
   {
     ASSERT_TRUE(pmwcas_target_.EmbedDescriptor(desc_));
 
-    pmwcas_target_.Recover(succeeded, desc_);
+    pmwcas_target_.Recover(succeeded, desc_, target_);
 
     if (succeeded) {
       EXPECT_EQ(new_val_, *target_);
@@ -205,6 +221,16 @@ TYPED_TEST(PMwCASTargetFixture, EmbedDescriptorWithUnexpectedValueFailEmbedding)
   TestFixture::VerifyEmbedDescriptor(true);
 }
 
+TYPED_TEST(PMwCASTargetFixture, MayHaveExpectedValueWithExpectedValueReturnTrue)
+{
+  TestFixture::VerifyMayHaveExpectedValue(false);
+}
+
+TYPED_TEST(PMwCASTargetFixture, MayHaveExpectedValueWithUnexpectedValueReturnFalse)
+{
+  TestFixture::VerifyMayHaveExpectedValue(true);
+}
+
 TYPED_TEST(PMwCASTargetFixture, CompletePMwCASWithSucceededStatusUpdateToDesiredValue)
 {
   TestFixture::VerifyCompletePMwCAS(true);
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 Database Group, Nagoya University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the corresponding header
+#include "pmem/atomic/component/stats.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+
+// external libraries
+#include "gtest/gtest.h"
+
+// local sources
+#include "common.hpp"
+#include "pmem/atomic/atomic.hpp"
+#include "pmem/atomic/component/persist.hpp"
+#include "pmem/atomic/descriptor_pool.hpp"
+
+namespace dbgroup::pmem::atomic::component::test
+{
+class StatsFixture : public ::testing::Test
+{
+ protected:
+  /*############################################################################
+   * Setup/Teardown
+   *##########################################################################*/
+
+  void
+  SetUp() override
+  {
+    pool_ = std::make_unique<DescriptorPool>(kVolatile);
+    DescriptorPool::ResetStats();
+  }
+
+  void
+  TearDown() override
+  {
+  }
+
+  /*############################################################################
+   * Utility functions
+   *##########################################################################*/
+
+  /**
+   * @param event A target event.
+   * @param n The number of events that should be counted if enabled.
+   */
+  static void
+  VerifyCount(  //
+      const StatEvent event,
+      const uint64_t n)
+  {
+    EXPECT_EQ(DescriptorPool::GetStats().Get(event), kEnableStats ? n : 0);
+  }
+
+  /*############################################################################
+   * Internal member variables
+   *##########################################################################*/
+
+  std::unique_ptr<DescriptorPool> pool_{nullptr};
+
+  alignas(kCacheLineSize) uint64_t words_[2]{};
+};
+
+/*##############################################################################
+ * Unit test definitions
+ *############################################################################*/
+
+TEST_F(StatsFixture, PCASCountsSuccessesAndFailures)
+{
+  uint64_t expected = 0;
+  EXPECT_TRUE(PCAS(&words_[0], expected, uint64_t{1}));
+  expected = 0;
+  EXPECT_FALSE(PCAS(&words_[0], expected, uint64_t{2}));
+
+  VerifyCount(StatEvent::kPCAS, 1);
+  VerifyCount(StatEvent::kPCASFailure, 1);
+  VerifyCount(StatEvent::kDrain, 1);
+  if (GetFlushType() != FlushType::kNone) {
+    VerifyCount(StatEvent::kFlush, 1);
+  }
+}
+
+TEST_F(StatsFixture, PMwCASCountsResultsAndLatency)
+{
+  auto *desc = pool_->Get();
+  desc->Add(&words_[0], uint64_t{0}, uint64_t{1});
+  desc->Add(&words_[1], uint64_t{0}, uint64_t{1});
+  EXPECT_TRUE(desc->PMwCAS());
+  desc->Add(&words_[0], uint64_t{0}, uint64_t{2});
+  EXPECT_FALSE(desc->PMwCAS());
+
+  VerifyCount(StatEvent::kPMwCAS, 1);
+  VerifyCount(StatEvent::kPMwCASFailure, 1);
+  const auto &latency = DescriptorPool::GetStats().pmwcas_latency;
+  EXPECT_EQ(std::accumulate(latency.begin(), latency.end(), uint64_t{0}), kEnableStats ? 2UL : 0UL);
+}
+
+TEST_F(StatsFixture, ResetStatsDiscardsCountedEvents)
+{
+  uint64_t expected = 0;
+  EXPECT_TRUE(PCAS(&words_[0], expected, uint64_t{1}));
+  DescriptorPool::ResetStats();
+
+  VerifyCount(StatEvent::kPCAS, 0);
+  expected = 1;
+  EXPECT_TRUE(PCAS(&words_[0], expected, uint64_t{2}));
+  VerifyCount(StatEvent::kPCAS, 1);
+}
+
+}  // namespace dbgroup::pmem::atomic::component::test